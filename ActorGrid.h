@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid over the XY plane, hashed into a power-of-two bucket table. Point indices are
+// counting-sorted by bucket, so a bucket is one contiguous run of entries. Point is any type with
+// float x, y and z members; the plugin uses RE::NiPoint3.
+template <typename Point>
+struct ActorGrid {
+    static constexpr float kCellSize = 512.0f;
+
+    uint32_t mask = 0;
+    std::vector<uint32_t> bucketStart;
+    std::vector<uint32_t> entries;
+
+    static int32_t Cell(float coordinate) { return static_cast<int32_t>(std::floor(coordinate / kCellSize)); }
+
+    static uint32_t Bucket(int32_t cellX, int32_t cellY, uint32_t mask) {
+        return ((static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u)) & mask;
+    }
+
+    void Build(const std::vector<Point>& positions) {
+        uint32_t buckets = std::bit_ceil(static_cast<uint32_t>(std::max<size_t>(positions.size() * 2, 16)));
+        mask = buckets - 1;
+        bucketStart.assign(buckets + 1, 0);
+        entries.resize(positions.size());
+
+        std::vector<uint32_t> pointBuckets(positions.size());
+        for (size_t i = 0; i < positions.size(); i++) {
+            pointBuckets[i] = Bucket(Cell(positions[i].x), Cell(positions[i].y), mask);
+            bucketStart[pointBuckets[i] + 1]++;
+        }
+        for (uint32_t b = 0; b < buckets; b++) {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+        std::vector<uint32_t> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (size_t i = 0; i < positions.size(); i++) {
+            entries[cursor[pointBuckets[i]]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Calls func(index) for each point of positions (the array the grid was built from) within
+    // radius of center, stopping early when func returns true. Falls back to a linear scan when
+    // the query box covers more than one cell per eight points, where walking buckets costs more
+    // than it saves.
+    template <typename Func>
+    bool ForEachInRadius(const std::vector<Point>& positions, const Point& center, float radius, Func&& func) const {
+        float radiusSq = radius * radius;
+        auto visit = [&](uint32_t i) -> bool {
+            float dx = positions[i].x - center.x;
+            float dy = positions[i].y - center.y;
+            float dz = positions[i].z - center.z;
+            return dx * dx + dy * dy + dz * dz <= radiusSq && func(i);
+        };
+
+        int32_t minX = Cell(center.x - radius);
+        int32_t maxX = Cell(center.x + radius);
+        int32_t minY = Cell(center.y - radius);
+        int32_t maxY = Cell(center.y + radius);
+        uint64_t cellCount = static_cast<uint64_t>(maxX - minX + 1) * static_cast<uint64_t>(maxY - minY + 1);
+
+        if (bucketStart.empty() || cellCount * 8 >= positions.size()) {
+            for (uint32_t i = 0; i < positions.size(); i++) {
+                if (visit(i)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        for (int32_t cellX = minX; cellX <= maxX; cellX++) {
+            for (int32_t cellY = minY; cellY <= maxY; cellY++) {
+                uint32_t bucket = Bucket(cellX, cellY, mask);
+                for (uint32_t e = bucketStart[bucket]; e < bucketStart[bucket + 1]; e++) {
+                    uint32_t i = entries[e];
+                    if (Cell(positions[i].x) == cellX && Cell(positions[i].y) == cellY && visit(i)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,400 @@
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Reader for the JSON strArg that OStim NG sends with its mod events. Engine-free so the replay tool
+// and tests can parse payloads without CommonLibSSE. Views in the payload point into the source text.
+
+struct OStimEventPayload {
+    static constexpr size_t kMaxActors = 16;
+    static constexpr size_t kMaxTags = 32;
+
+    std::string_view sceneID;
+    std::array<uint32_t, kMaxActors> actors{};
+    size_t actorCount = 0;
+    int threadID = -1;
+    int speed = -1;
+    std::array<std::string_view, kMaxTags> tags{};
+    size_t tagCount = 0;
+};
+
+struct OStimJsonReader {
+    std::string_view text;
+    size_t pos = 0;
+
+    static bool LooksLikeJson(std::string_view json) {
+        size_t first = json.find_first_not_of(" \t\r\n");
+        return first != std::string_view::npos && json[first] == '{';
+    }
+
+    static bool Parse(std::string_view json, OStimEventPayload& payload) {
+        payload = OStimEventPayload{};
+        if (!LooksLikeJson(json)) {
+            return false;
+        }
+
+        OStimJsonReader reader{json, 0};
+        reader.SkipWhitespace();
+        if (!reader.Consume('{')) {
+            return false;
+        }
+
+        reader.SkipWhitespace();
+        if (reader.Consume('}')) {
+            return true;
+        }
+
+        while (true) {
+            std::string_view key;
+            reader.SkipWhitespace();
+            if (!reader.ReadString(key)) {
+                return false;
+            }
+            reader.SkipWhitespace();
+            if (!reader.Consume(':')) {
+                return false;
+            }
+            reader.SkipWhitespace();
+
+            bool ok;
+            if (reader.ConsumeNull()) {
+                ok = true;
+            } else if (KeyIs(key, "scene") || KeyIs(key, "sceneid") || KeyIs(key, "scene_id")) {
+                ok = reader.ReadString(payload.sceneID);
+            } else if (KeyIs(key, "actors")) {
+                ok = reader.ReadActors(payload);
+            } else if (KeyIs(key, "thread") || KeyIs(key, "threadid") || KeyIs(key, "thread_id")) {
+                int64_t value = 0;
+                ok = reader.ReadInteger(value);
+                payload.threadID = static_cast<int>(value);
+            } else if (KeyIs(key, "speed")) {
+                int64_t value = 0;
+                ok = reader.ReadInteger(value);
+                payload.speed = static_cast<int>(value);
+            } else if (KeyIs(key, "tags")) {
+                ok = reader.ReadTags(payload);
+            } else {
+                ok = reader.SkipValue();
+            }
+            if (!ok) {
+                return false;
+            }
+
+            reader.SkipWhitespace();
+            if (reader.Consume(',')) {
+                continue;
+            }
+            return reader.Consume('}');
+        }
+    }
+
+    static bool KeyIs(std::string_view key, std::string_view lowerName) {
+        if (key.size() != lowerName.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < key.size(); i++) {
+            char c = key[i];
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+            if (c != lowerName[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void SkipWhitespace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) {
+            pos++;
+        }
+    }
+
+    bool Consume(char expected) {
+        if (pos < text.size() && text[pos] == expected) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    // A null value reads as if the key were absent.
+    bool ConsumeNull() {
+        if (text.substr(pos).starts_with("null")) {
+            pos += 4;
+            return true;
+        }
+        return false;
+    }
+
+    bool ReadString(std::string_view& out) {
+        if (!Consume('"')) {
+            return false;
+        }
+        size_t start = pos;
+        while (pos < text.size()) {
+            char c = text[pos];
+            if (c == '\\') {
+                pos += 2;
+                continue;
+            }
+            if (c == '"') {
+                out = text.substr(start, pos - start);
+                pos++;
+                return true;
+            }
+            pos++;
+        }
+        return false;
+    }
+
+    bool ReadInteger(int64_t& value) {
+        std::string_view quoted;
+        if (pos < text.size() && text[pos] == '"') {
+            if (!ReadString(quoted)) {
+                return false;
+            }
+            auto result = std::from_chars(quoted.data(), quoted.data() + quoted.size(), value);
+            return result.ec == std::errc();
+        }
+
+        auto result = std::from_chars(text.data() + pos, text.data() + text.size(), value);
+        if (result.ec != std::errc()) {
+            return false;
+        }
+        pos = result.ptr - text.data();
+        if (pos < text.size() && (text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E')) {
+            return SkipValue();
+        }
+        return true;
+    }
+
+    bool ReadFormID(uint32_t& formID) {
+        if (ConsumeNull()) {
+            formID = 0;
+            return true;
+        }
+        if (pos < text.size() && text[pos] == '"') {
+            std::string_view hex;
+            if (!ReadString(hex)) {
+                return false;
+            }
+            if (hex.size() > 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) {
+                hex.remove_prefix(2);
+            }
+            uint32_t value = 0;
+            auto result = std::from_chars(hex.data(), hex.data() + hex.size(), value, 16);
+            if (result.ec != std::errc() || result.ptr != hex.data() + hex.size()) {
+                formID = 0;
+                return true;
+            }
+            formID = value;
+            return true;
+        }
+
+        if (pos < text.size() && text[pos] == '{') {
+            formID = 0;
+            pos++;
+            SkipWhitespace();
+            if (Consume('}')) {
+                return true;
+            }
+            while (true) {
+                std::string_view key;
+                SkipWhitespace();
+                if (!ReadString(key)) {
+                    return false;
+                }
+                SkipWhitespace();
+                if (!Consume(':')) {
+                    return false;
+                }
+                SkipWhitespace();
+                bool ok = (KeyIs(key, "formid") || KeyIs(key, "id")) ? ReadFormID(formID) : SkipValue();
+                if (!ok) {
+                    return false;
+                }
+                SkipWhitespace();
+                if (Consume(',')) {
+                    continue;
+                }
+                return Consume('}');
+            }
+        }
+
+        int64_t value = 0;
+        if (!ReadInteger(value)) {
+            return false;
+        }
+        formID = static_cast<uint32_t>(static_cast<uint32_t>(value));
+        return true;
+    }
+
+    bool ReadActors(OStimEventPayload& payload) {
+        if (!Consume('[')) {
+            return SkipValue();
+        }
+        SkipWhitespace();
+        if (Consume(']')) {
+            return true;
+        }
+        while (true) {
+            SkipWhitespace();
+            uint32_t formID = 0;
+            if (!ReadFormID(formID)) {
+                return false;
+            }
+            if (formID != 0 && payload.actorCount < OStimEventPayload::kMaxActors) {
+                payload.actors[payload.actorCount++] = formID;
+            }
+            SkipWhitespace();
+            if (Consume(',')) {
+                continue;
+            }
+            return Consume(']');
+        }
+    }
+
+    bool ReadTags(OStimEventPayload& payload) {
+        if (pos < text.size() && text[pos] == '"') {
+            std::string_view list;
+            if (!ReadString(list)) {
+                return false;
+            }
+            while (!list.empty()) {
+                size_t comma = list.find(',');
+                std::string_view tag = list.substr(0, comma);
+                while (!tag.empty() && tag.front() == ' ') {
+                    tag.remove_prefix(1);
+                }
+                while (!tag.empty() && tag.back() == ' ') {
+                    tag.remove_suffix(1);
+                }
+                if (!tag.empty() && payload.tagCount < OStimEventPayload::kMaxTags) {
+                    payload.tags[payload.tagCount++] = tag;
+                }
+                if (comma == std::string_view::npos) {
+                    break;
+                }
+                list.remove_prefix(comma + 1);
+            }
+            return true;
+        }
+
+        if (!Consume('[')) {
+            return SkipValue();
+        }
+        SkipWhitespace();
+        if (Consume(']')) {
+            return true;
+        }
+        while (true) {
+            SkipWhitespace();
+            std::string_view tag;
+            if (pos < text.size() && text[pos] == '"') {
+                if (!ReadString(tag)) {
+                    return false;
+                }
+                if (!tag.empty() && payload.tagCount < OStimEventPayload::kMaxTags) {
+                    payload.tags[payload.tagCount++] = tag;
+                }
+            } else if (!SkipValue()) {
+                return false;
+            }
+            SkipWhitespace();
+            if (Consume(',')) {
+                continue;
+            }
+            return Consume(']');
+        }
+    }
+
+    template <typename MemberHandler>
+    bool ForEachMember(MemberHandler&& handler) {
+        SkipWhitespace();
+        if (!Consume('{')) {
+            return SkipValue();
+        }
+        SkipWhitespace();
+        if (Consume('}')) {
+            return true;
+        }
+        while (true) {
+            std::string_view key;
+            SkipWhitespace();
+            if (!ReadString(key)) {
+                return false;
+            }
+            SkipWhitespace();
+            if (!Consume(':')) {
+                return false;
+            }
+            SkipWhitespace();
+            if (!handler(key)) {
+                return false;
+            }
+            SkipWhitespace();
+            if (Consume(',')) {
+                continue;
+            }
+            return Consume('}');
+        }
+    }
+
+    template <typename ElementHandler>
+    bool ForEachElement(ElementHandler&& handler) {
+        SkipWhitespace();
+        if (!Consume('[')) {
+            return SkipValue();
+        }
+        SkipWhitespace();
+        if (Consume(']')) {
+            return true;
+        }
+        while (true) {
+            SkipWhitespace();
+            if (!handler()) {
+                return false;
+            }
+            SkipWhitespace();
+            if (Consume(',')) {
+                continue;
+            }
+            return Consume(']');
+        }
+    }
+
+    bool SkipValue() {
+        int depth = 0;
+        while (pos < text.size()) {
+            char c = text[pos];
+            if (c == '"') {
+                std::string_view ignored;
+                if (!ReadString(ignored)) {
+                    return false;
+                }
+            } else if (c == '{' || c == '[') {
+                depth++;
+                pos++;
+            } else if (c == '}' || c == ']') {
+                if (depth == 0) {
+                    return true;
+                }
+                depth--;
+                pos++;
+            } else if (c == ',' && depth == 0) {
+                return true;
+            } else {
+                pos++;
+            }
+            if (depth == 0 && pos < text.size() && (text[pos] == ',' || text[pos] == '}' || text[pos] == ']')) {
+                return true;
+            }
+        }
+        return depth == 0;
+    }
+};
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#define ORISK_LOG_SCANNER_SIMD 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#define ORISK_TARGET_AVX2
+#else
+#define ORISK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// OStim.log line splitting and the cheap per-line checks that run before a line reaches the scene
+// strand. Engine-free so the replay tool and tests share the plugin's exact scanner.
+
+using FindNewlineFunc = const char* (*)(const char* begin, const char* end);
+
+inline const char* FindNextNewlineScalar(const char* begin, const char* end) {
+    return static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+}
+
+#ifdef ORISK_LOG_SCANNER_SIMD
+inline const char* FindNextNewlineSSE2(const char* begin, const char* end) {
+    const char* cursor = begin;
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    while (end - cursor >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        if (mask != 0) {
+            return cursor + std::countr_zero(static_cast<unsigned int>(mask));
+        }
+        cursor += 16;
+    }
+
+    return FindNextNewlineScalar(cursor, end);
+}
+
+ORISK_TARGET_AVX2 inline const char* FindNextNewlineAVX2(const char* begin, const char* end) {
+    const char* cursor = begin;
+    const __m256i newline = _mm256_set1_epi8('\n');
+
+    while (end - cursor >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cursor));
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, newline)));
+        if (mask != 0) {
+            return cursor + std::countr_zero(mask);
+        }
+        cursor += 32;
+    }
+
+    return FindNextNewlineSSE2(cursor, end);
+}
+
+inline bool IsAVX2Supported() {
+#ifdef _MSC_VER
+    int cpuInfo[4] = {0, 0, 0, 0};
+    __cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7) {
+        return false;
+    }
+
+    __cpuid(cpuInfo, 1);
+    bool osxsave = (cpuInfo[2] & (1 << 27)) != 0;
+    bool avx = (cpuInfo[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return false;
+    }
+
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(cpuInfo, 7, 0);
+    return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+inline const char* FindPreviousNewline(const char* begin, const char* end) {
+    const char* cursor = end;
+    const __m128i newline = _mm_set1_epi8('\n');
+
+    while (cursor - begin >= 16) {
+        cursor -= 16;
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cursor));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        if (mask != 0) {
+            return cursor + (std::bit_width(static_cast<unsigned int>(mask)) - 1);
+        }
+    }
+
+    while (cursor > begin) {
+        --cursor;
+        if (*cursor == '\n') {
+            return cursor;
+        }
+    }
+
+    return nullptr;
+}
+#else
+// Non-x86 hosts only build the tests and tools; the plugin always takes the SIMD path.
+inline const char* FindNextNewlineSSE2(const char* begin, const char* end) {
+    return FindNextNewlineScalar(begin, end);
+}
+
+inline const char* FindNextNewlineAVX2(const char* begin, const char* end) {
+    return FindNextNewlineScalar(begin, end);
+}
+
+inline bool IsAVX2Supported() {
+    return false;
+}
+
+inline const char* FindPreviousNewline(const char* begin, const char* end) {
+    for (const char* cursor = end; cursor > begin;) {
+        if (*--cursor == '\n') {
+            return cursor;
+        }
+    }
+    return nullptr;
+}
+#endif
+
+// Calls onLine with each complete line in [data, data + length), minus any trailing '\r'. Returns
+// the bytes consumed; an unterminated last line is left for the next chunk.
+template <typename OnLine>
+size_t SplitLogLines(const char* data, size_t length, FindNewlineFunc findNewline, OnLine&& onLine) {
+    const char* end = data + length;
+    const char* lineStart = data;
+
+    while (lineStart < end) {
+        const char* newlinePos = findNewline(lineStart, end);
+        if (!newlinePos) {
+            break;
+        }
+
+        const char* contentEnd = newlinePos;
+        if (contentEnd > lineStart && *(contentEnd - 1) == '\r') {
+            --contentEnd;
+        }
+
+        onLine(std::string_view(lineStart, contentEnd - lineStart));
+        lineStart = newlinePos + 1;
+    }
+
+    return lineStart - data;
+}
+
+inline bool LineMayContainMarker(std::string_view line) {
+    size_t tokenStart = line.find('[');
+    int tokensChecked = 0;
+
+    while (tokenStart != std::string_view::npos && tokensChecked < 4) {
+        std::string_view token = line.substr(tokenStart + 1);
+        if (token.starts_with("Thread.cpp") || token.starts_with("Graph.cpp") ||
+            token.starts_with("OStimMenu.h") || token.starts_with("ThreadManager.cpp")) {
+            return true;
+        }
+        tokenStart = line.find('[', tokenStart + 1);
+        tokensChecked++;
+    }
+
+    return line.find("found for actor") != std::string_view::npos;
+}
+
+inline bool IsSceneEndMarker(std::string_view line) {
+    return line.find("[Thread.cpp:634] closing thread") != std::string_view::npos ||
+           line.find("[ThreadManager.cpp:174] trying to stop thread") != std::string_view::npos;
+}
+
+inline int ParseThreadIDFromLine(std::string_view line) {
+    size_t searchPos = 0;
+    while (true) {
+        size_t threadPos = line.find("thread ", searchPos);
+        if (threadPos == std::string_view::npos) {
+            return -1;
+        }
+
+        size_t digitPos = threadPos + 7;
+        if (digitPos < line.size() && line[digitPos] >= '0' && line[digitPos] <= '9') {
+            int threadID = 0;
+            while (digitPos < line.size() && line[digitPos] >= '0' && line[digitPos] <= '9') {
+                threadID = threadID * 10 + (line[digitPos] - '0');
+                digitPos++;
+            }
+            return threadID;
+        }
+
+        searchPos = threadPos + 7;
+    }
+}
+
+// Reads the time of day from the leading "[...]" timestamp, taking the last four digit groups as
+// h:m:s.ms so a date prefix is ignored.
+inline bool ParseLogLineTimeOfDayMs(std::string_view line, long long& msOfDay) {
+    if (line.empty() || line[0] != '[') {
+        return false;
+    }
+
+    size_t tokenEnd = line.find(']');
+    if (tokenEnd == std::string_view::npos) {
+        return false;
+    }
+
+    long long groups[8] = {};
+    int groupCount = 0;
+    bool inNumber = false;
+
+    for (size_t i = 1; i < tokenEnd; i++) {
+        char c = line[i];
+        if (c >= '0' && c <= '9') {
+            if (!inNumber) {
+                if (groupCount == 8) {
+                    return false;
+                }
+                groupCount++;
+                inNumber = true;
+            }
+            groups[groupCount - 1] = groups[groupCount - 1] * 10 + (c - '0');
+        } else {
+            inNumber = false;
+        }
+    }
+
+    if (groupCount < 3) {
+        return false;
+    }
+
+    if (groupCount == 3) {
+        msOfDay = ((groups[0] * 60 + groups[1]) * 60 + groups[2]) * 1000;
+    } else {
+        const long long* t = groups + groupCount - 4;
+        msOfDay = ((t[0] * 60 + t[1]) * 60 + t[2]) * 1000 + t[3];
+    }
+    return true;
+}
+
+// The node an OStim.log line switches thread 0 to, or an empty view. Points into line.
+inline std::string_view DetectAnimationChange(std::string_view line) {
+    std::string_view animationName;
+
+    if (line.find("[info]") != std::string_view::npos &&
+        line.find("[Thread.cpp:195] thread 0 changed to node") != std::string_view::npos) {
+        size_t nodePos = line.find("changed to node ");
+        if (nodePos != std::string_view::npos) {
+            size_t startPos = nodePos + 16;
+            if (startPos < line.length()) {
+                animationName = line.substr(startPos);
+            }
+        }
+    } else if (line.find("[info]") != std::string_view::npos &&
+               line.find("[OStimMenu.h:48] UI_TransitionRequest") != std::string_view::npos) {
+        size_t lastOpenBrace = line.rfind('{');
+        size_t lastCloseBrace = line.rfind('}');
+        if (lastOpenBrace != std::string_view::npos && lastCloseBrace != std::string_view::npos &&
+            lastCloseBrace > lastOpenBrace) {
+            animationName = line.substr(lastOpenBrace + 1, lastCloseBrace - lastOpenBrace - 1);
+        }
+    }
+
+    size_t last = animationName.find_last_not_of(" \n\r\t");
+    return last == std::string_view::npos ? std::string_view() : animationName.substr(0, last + 1);
+}
+
+// The actor name from a "voice set ... found for actor <name> by|, using ..." line, or an empty
+// view. Points into line.
+inline std::string_view ExtractVoiceSetActorName(std::string_view line) {
+    bool hasVoiceSetFound = (line.find("voice set") != std::string_view::npos &&
+                             line.find("found for actor") != std::string_view::npos);
+    bool hasNoVoiceSet = (line.find("no voice set found for actor") != std::string_view::npos);
+
+    if (!hasVoiceSetFound && !hasNoVoiceSet) {
+        return {};
+    }
+
+    size_t actorPos = line.find("found for actor ");
+    if (actorPos == std::string_view::npos) {
+        return {};
+    }
+
+    size_t nameStart = actorPos + 16;
+    size_t nameEnd = std::min(line.find(" by", nameStart), line.find(", using", nameStart));
+    if (nameEnd == std::string_view::npos || nameEnd <= nameStart) {
+        return {};
+    }
+
+    std::string_view name = line.substr(nameStart, nameEnd - nameStart);
+    size_t first = name.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    name = name.substr(first, name.find_last_not_of(" \t\r\n") - first + 1);
+    return name == "," ? std::string_view() : name;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+
+// Scene lifecycle shared by the OStim.log scraper, mod events and the monitor tick. Kept free of
+// engine headers so the transition table can be tested on its own.
+
+enum class SceneState : uint8_t {
+    Idle,
+    Prestart,
+    Active,
+    Ending,
+    CleanupPending
+};
+
+enum class SceneInputKind : uint8_t {
+    Prestart,
+    SceneStart,
+    End,
+    CleanupDue,
+    CleanupDone
+};
+
+enum SceneAction : uint32_t {
+    kSceneActionNone = 0,
+    kSceneActionBuildCache = 1 << 0,
+    kSceneActionStartScene = 1 << 1,
+    kSceneActionEndScene = 1 << 2,
+    kSceneActionRunCleanup = 1 << 3,
+    kSceneActionClearCache = 1 << 4,
+    kSceneActionDeferInput = 1 << 5
+};
+
+// How long Ending waits for OStim to tear the thread down before CleanupDue. Replays measure it in
+// log time rather than wall time.
+constexpr int64_t kSceneCleanupDelayMs = 1000;
+
+struct SceneTransition {
+    SceneState next;
+    uint32_t actions;
+};
+
+inline const char* GetSceneStateName(SceneState state) {
+    switch (state) {
+        case SceneState::Idle: return "Idle";
+        case SceneState::Prestart: return "Prestart";
+        case SceneState::Active: return "Active";
+        case SceneState::Ending: return "Ending";
+        case SceneState::CleanupPending: return "CleanupPending";
+    }
+    return "Unknown";
+}
+
+inline const char* GetSceneInputName(SceneInputKind kind) {
+    switch (kind) {
+        case SceneInputKind::Prestart: return "Prestart";
+        case SceneInputKind::SceneStart: return "SceneStart";
+        case SceneInputKind::End: return "End";
+        case SceneInputKind::CleanupDue: return "CleanupDue";
+        case SceneInputKind::CleanupDone: return "CleanupDone";
+    }
+    return "Unknown";
+}
+
+// A new scene that arrives while the previous one is Ending is deferred, not started: cleanup
+// still waits out its delay after OStim's end so the two do not collide, and the deferred input
+// is replayed once the machine is back at Idle. CleanupPending lasts from the cleanup run until
+// the separate CleanupDone input.
+inline SceneTransition EvaluateSceneTransition(SceneState state, SceneInputKind input) {
+    switch (state) {
+        case SceneState::Idle:
+            switch (input) {
+                case SceneInputKind::Prestart: return {SceneState::Prestart, kSceneActionBuildCache};
+                case SceneInputKind::SceneStart: return {SceneState::Active, kSceneActionBuildCache | kSceneActionStartScene};
+                default: return {SceneState::Idle, kSceneActionNone};
+            }
+        case SceneState::Prestart:
+            switch (input) {
+                case SceneInputKind::SceneStart: return {SceneState::Active, kSceneActionStartScene};
+                case SceneInputKind::End: return {SceneState::Idle, kSceneActionClearCache};
+                default: return {SceneState::Prestart, kSceneActionNone};
+            }
+        case SceneState::Active:
+            switch (input) {
+                case SceneInputKind::End: return {SceneState::Ending, kSceneActionEndScene};
+                default: return {SceneState::Active, kSceneActionNone};
+            }
+        case SceneState::Ending:
+            switch (input) {
+                case SceneInputKind::Prestart:
+                case SceneInputKind::SceneStart: return {SceneState::Ending, kSceneActionDeferInput};
+                case SceneInputKind::CleanupDue: return {SceneState::CleanupPending, kSceneActionRunCleanup};
+                default: return {SceneState::Ending, kSceneActionNone};
+            }
+        case SceneState::CleanupPending:
+            switch (input) {
+                case SceneInputKind::Prestart: return {SceneState::Prestart, kSceneActionBuildCache};
+                case SceneInputKind::SceneStart: return {SceneState::Active, kSceneActionBuildCache | kSceneActionStartScene};
+                case SceneInputKind::CleanupDone: return {SceneState::Idle, kSceneActionNone};
+                default: return {SceneState::CleanupPending, kSceneActionNone};
+            }
+    }
+    return {state, kSceneActionNone};
+}
@@ -0,0 +1,674 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Scene tags: the known heuristic tags, the interned tag table, the compile-time keyword automaton
+// and the runtime tag rules automaton. Free of engine headers so the OStim.log replay tool and the
+// tests share them with the plugin.
+
+enum SceneTagBit : uint64_t {
+    kSceneTagStanding = 1ull << 0,
+    kSceneTagSitting = 1ull << 1,
+    kSceneTagLying = 1ull << 2,
+    kSceneTagDoggy = 1ull << 3,
+    kSceneTagMissionary = 1ull << 4,
+    kSceneTagOral = 1ull << 5,
+    kSceneTagVaginal = 1ull << 6,
+    kSceneTagAnal = 1ull << 7,
+    kSceneTagKissing = 1ull << 8,
+    kSceneTagTouching = 1ull << 9,
+    kSceneTagRough = 1ull << 10,
+    kSceneTagGentle = 1ull << 11,
+    kSceneTagAggressive = 1ull << 12,
+    kSceneTagIntimate = 1ull << 13,
+    kSceneTagTransition = 1ull << 14,
+    kSceneTagSpread = 1ull << 15,
+    kSceneTagPressing = 1ull << 16,
+    kSceneTagOARE = 1ull << 17,
+    kSceneTagCount = 18
+};
+
+constexpr std::array<const char*, kSceneTagCount> kSceneTagNames = {
+    "Standing", "Sitting", "Lying", "Doggy", "Missionary", "Oral", "Vaginal", "Anal", "Kissing",
+    "Touching", "Rough", "Gentle", "Aggressive", "Intimate", "Transition", "Spread", "Pressing", "OARE"};
+
+enum KnownTagID : uint32_t {
+    kTagIDHighIntensity = kSceneTagCount,
+    kTagIDMediumIntensity,
+    kTagIDLowIntensity,
+    kTagIDClimax,
+    kKnownTagCount
+};
+
+constexpr uint32_t kFirstInternedTagID = 32;
+constexpr uint32_t kInvalidTagID = 0xFFFFFFFF;
+// Bit IDs that metadata tags may not take, so tags named in the INI or the tag rules still get one
+// after a long session has seen hundreds of distinct OStim metadata tags.
+constexpr uint32_t kConfiguredTagReserve = 64;
+
+static_assert(kKnownTagCount <= kFirstInternedTagID, "Known tags must fit below the interned range");
+
+// Fixed-width tag set: IDs below kFirstInternedTagID are the known heuristic tags, the rest are
+// assigned by TagNameTable to OStim metadata tags on first sight.
+struct TagSet {
+    static constexpr size_t kWords = 4;
+    static constexpr uint32_t kCapacity = kWords * 64;
+
+    std::array<uint64_t, kWords> words{};
+
+    static TagSet FromBits(uint64_t bits) {
+        TagSet set;
+        set.words[0] = bits;
+        return set;
+    }
+
+    void Add(uint32_t id) {
+        if (id < kCapacity) {
+            words[id >> 6] |= 1ull << (id & 63);
+        }
+    }
+
+    bool Has(uint32_t id) const { return id < kCapacity && ((words[id >> 6] >> (id & 63)) & 1) != 0; }
+
+    bool HasAny(uint64_t knownBits) const { return (words[0] & knownBits) != 0; }
+
+    void Clear() { words.fill(0); }
+
+    bool Empty() const { return (words[0] | words[1] | words[2] | words[3]) == 0; }
+
+    size_t Count() const {
+        return std::popcount(words[0]) + std::popcount(words[1]) + std::popcount(words[2]) + std::popcount(words[3]);
+    }
+
+    bool Intersects(const TagSet& other) const {
+        return ((words[0] & other.words[0]) | (words[1] & other.words[1]) | (words[2] & other.words[2]) |
+                (words[3] & other.words[3])) != 0;
+    }
+
+    bool IsSubsetOf(const TagSet& other) const {
+        return ((words[0] & ~other.words[0]) | (words[1] & ~other.words[1]) | (words[2] & ~other.words[2]) |
+                (words[3] & ~other.words[3])) == 0;
+    }
+
+    TagSet& operator|=(const TagSet& other) {
+        for (size_t i = 0; i < kWords; i++) {
+            words[i] |= other.words[i];
+        }
+        return *this;
+    }
+
+    bool operator==(const TagSet& other) const = default;
+
+    template <typename Func>
+    void ForEach(Func&& func) const {
+        for (size_t i = 0; i < kWords; i++) {
+            uint64_t bits = words[i];
+            while (bits) {
+                func(static_cast<uint32_t>(i * 64 + std::countr_zero(bits)));
+                bits &= bits - 1;
+            }
+        }
+    }
+};
+
+struct TagNameTable {
+    static TagNameTable& Get() {
+        static TagNameTable table;
+        return table;
+    }
+
+    // Metadata tags: a TagSet bit while the unreserved range lasts, then an overflow ID at or above
+    // TagSet::kCapacity that keeps its name but is never set in a TagSet.
+    uint32_t Intern(std::string_view name) {
+        std::string key = FoldKey(name);
+        if (key.empty()) {
+            return kInvalidTagID;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ids.find(key);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        uint32_t id;
+        if (nextID < TagSet::kCapacity - kConfiguredTagReserve) {
+            id = nextID++;
+            names[id] = std::string(name);
+        } else {
+            id = TagSet::kCapacity + static_cast<uint32_t>(overflowNames.size());
+            overflowNames.emplace_back(name);
+        }
+        ids.emplace(std::move(key), id);
+        return id;
+    }
+
+    // Configured and rule tags: may use the reserved bits, and take over a bit for a name that was
+    // already pushed into the overflow range. Returns kInvalidTagID only when every bit is in use.
+    uint32_t InternConfigured(std::string_view name) {
+        std::string key = FoldKey(name);
+        if (key.empty()) {
+            return kInvalidTagID;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ids.find(key);
+        if (it != ids.end() && it->second < TagSet::kCapacity) {
+            return it->second;
+        }
+        if (nextID >= TagSet::kCapacity) {
+            return kInvalidTagID;
+        }
+        uint32_t id = nextID++;
+        names[id] = std::string(name);
+        ids.insert_or_assign(std::move(key), id);
+        return id;
+    }
+
+    std::string_view Name(uint32_t id) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (id < TagSet::kCapacity) {
+            return names[id];
+        }
+        return id - TagSet::kCapacity < overflowNames.size() ? std::string_view(overflowNames[id - TagSet::kCapacity]) : "?";
+    }
+
+    size_t InternedCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nextID - kFirstInternedTagID;
+    }
+
+    size_t OverflowCount() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return overflowNames.size();
+    }
+
+private:
+    TagNameTable() {
+        for (uint32_t id = 0; id < kSceneTagCount; id++) {
+            Seed(id, kSceneTagNames[id]);
+        }
+        Seed(kTagIDHighIntensity, "HighIntensity");
+        Seed(kTagIDMediumIntensity, "MediumIntensity");
+        Seed(kTagIDLowIntensity, "LowIntensity");
+        Seed(kTagIDClimax, "Climax");
+    }
+
+    void Seed(uint32_t id, const char* name) {
+        names[id] = name;
+        ids.emplace(FoldKey(name), id);
+    }
+
+    static std::string FoldKey(std::string_view name) {
+        size_t begin = name.find_first_not_of(" \t\r\n");
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        size_t end = name.find_last_not_of(" \t\r\n");
+        std::string key(name.substr(begin, end - begin + 1));
+        for (char& c : key) {
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return key;
+    }
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> ids;
+    std::array<std::string, TagSet::kCapacity> names;
+    std::deque<std::string> overflowNames;
+    uint32_t nextID = kFirstInternedTagID;
+};
+
+inline std::string FormatTagSet(const TagSet& tags, std::string_view separator = ", ") {
+    std::string formatted;
+    tags.ForEach([&](uint32_t id) {
+        if (!formatted.empty()) {
+            formatted += separator;
+        }
+        formatted += TagNameTable::Get().Name(id);
+    });
+    return formatted;
+}
+
+struct TagKeyword {
+    std::string_view keyword;
+    uint32_t tagBit;
+};
+
+constexpr std::array<TagKeyword, 29> kAnimationTagKeywords = {{
+    {"standing", kSceneTagStanding},
+    {"sitting", kSceneTagSitting},
+    {"lying", kSceneTagLying},
+    {"laying", kSceneTagLying},
+    {"doggy", kSceneTagDoggy},
+    {"behind", kSceneTagDoggy},
+    {"missionary", kSceneTagMissionary},
+    {"mating", kSceneTagMissionary},
+    {"oral", kSceneTagOral},
+    {"bj", kSceneTagOral},
+    {"blowjob", kSceneTagOral},
+    {"vaginal", kSceneTagVaginal},
+    {"penetration", kSceneTagVaginal},
+    {"anal", kSceneTagAnal},
+    {"kiss", kSceneTagKissing},
+    {"touch", kSceneTagTouching},
+    {"caress", kSceneTagTouching},
+    {"rough", kSceneTagRough},
+    {"hard", kSceneTagRough},
+    {"gentle", kSceneTagGentle},
+    {"soft", kSceneTagGentle},
+    {"aggressive", kSceneTagAggressive},
+    {"dom", kSceneTagAggressive},
+    {"close", kSceneTagIntimate},
+    {"approach", kSceneTagTransition},
+    {"goto", kSceneTagTransition},
+    {"spread", kSceneTagSpread},
+    {"press", kSceneTagPressing},
+    {"oare", kSceneTagOARE},
+}};
+
+constexpr size_t CountTagKeywordStates() {
+    size_t states = 1;
+    for (const auto& entry : kAnimationTagKeywords) {
+        states += entry.keyword.size();
+    }
+    return states;
+}
+
+// Aho-Corasick automaton over the keyword table, built at compile time. Letters are folded to
+// 26 classes and every other byte resets to the root, so matching is one table step per byte.
+struct TagKeywordAutomaton {
+    static constexpr size_t kAlphabet = 27;
+    static constexpr size_t kMaxStates = CountTagKeywordStates();
+
+    std::array<uint8_t, 256> charClass{};
+    std::array<std::array<uint8_t, kAlphabet>, kMaxStates> next{};
+    std::array<uint32_t, kMaxStates> output{};
+    size_t stateCount = 1;
+
+    constexpr uint32_t Match(std::string_view text) const {
+        uint32_t mask = 0;
+        uint8_t state = 0;
+        for (char c : text) {
+            state = next[state][charClass[static_cast<uint8_t>(c)]];
+            mask |= output[state];
+        }
+        return mask;
+    }
+};
+
+static_assert(TagKeywordAutomaton::kMaxStates <= 256, "Tag keyword automaton states must fit in uint8_t");
+static_assert(kSceneTagCount <= 32, "Tag keyword masks are 32 bits wide");
+
+consteval TagKeywordAutomaton BuildTagKeywordAutomaton() {
+    constexpr size_t kAlphabet = TagKeywordAutomaton::kAlphabet;
+    constexpr size_t kMaxStates = TagKeywordAutomaton::kMaxStates;
+
+    TagKeywordAutomaton automaton;
+    for (int c = 'a'; c <= 'z'; c++) {
+        automaton.charClass[c] = static_cast<uint8_t>(c - 'a' + 1);
+        automaton.charClass[c - 'a' + 'A'] = static_cast<uint8_t>(c - 'a' + 1);
+    }
+
+    std::array<std::array<int, kAlphabet>, kMaxStates> trie{};
+    for (auto& row : trie) {
+        row.fill(-1);
+    }
+    for (const auto& entry : kAnimationTagKeywords) {
+        size_t state = 0;
+        for (char c : entry.keyword) {
+            uint8_t cls = automaton.charClass[static_cast<uint8_t>(c)];
+            if (trie[state][cls] < 0) {
+                trie[state][cls] = static_cast<int>(automaton.stateCount++);
+            }
+            state = static_cast<size_t>(trie[state][cls]);
+        }
+        automaton.output[state] |= entry.tagBit;
+    }
+
+    std::array<uint8_t, kMaxStates> fail{};
+    std::array<uint8_t, kMaxStates> queue{};
+    size_t head = 0;
+    size_t tail = 0;
+    for (size_t cls = 0; cls < kAlphabet; cls++) {
+        if (trie[0][cls] >= 0) {
+            uint8_t child = static_cast<uint8_t>(trie[0][cls]);
+            automaton.next[0][cls] = child;
+            fail[child] = 0;
+            queue[tail++] = child;
+        }
+    }
+    while (head < tail) {
+        uint8_t state = queue[head++];
+        automaton.output[state] |= automaton.output[fail[state]];
+        for (size_t cls = 0; cls < kAlphabet; cls++) {
+            if (trie[state][cls] >= 0) {
+                uint8_t child = static_cast<uint8_t>(trie[state][cls]);
+                fail[child] = automaton.next[fail[state]][cls];
+                automaton.next[state][cls] = child;
+                queue[tail++] = child;
+            } else {
+                automaton.next[state][cls] = automaton.next[fail[state]][cls];
+            }
+        }
+    }
+    return automaton;
+}
+
+constexpr TagKeywordAutomaton kTagKeywordAutomaton = BuildTagKeywordAutomaton();
+
+static_assert(kTagKeywordAutomaton.Match("OStim_Standing_BJ") == (kSceneTagStanding | kSceneTagOral));
+static_assert(kTagKeywordAutomaton.Match("ostim_bed_blowjob") == kSceneTagOral);
+static_assert(kTagKeywordAutomaton.Match("closecaress") == (kSceneTagIntimate | kSceneTagTouching));
+
+struct TagRuleOutput {
+    TagSet tags;
+    TagSet guardedHits;
+    TagSet exclusionHits;
+};
+
+// Runtime counterpart of TagKeywordAutomaton, compiled from the tag rules file. Class 0 is the word
+// boundary symbol: it is fed before and after the name and for every non-letter byte, so word-bound
+// keywords are stored with boundary edges. Rules with exclusions report through guardedHits and only
+// apply when none of their exclusion words were seen.
+struct TagRuleAutomaton {
+    static constexpr size_t kAlphabet = TagKeywordAutomaton::kAlphabet;
+    static constexpr uint8_t kBoundary = 0;
+    static constexpr size_t kMaxStates = 65535;
+    static constexpr size_t kMaxGuardedRules = TagSet::kCapacity;
+
+    std::array<uint8_t, 256> charClass{};
+    std::vector<uint16_t> next;
+    std::vector<uint16_t> outputIndex;
+    std::vector<TagRuleOutput> outputs;
+    std::vector<uint32_t> guardedTags;
+    size_t ruleCount = 0;
+
+    size_t StateCount() const { return outputIndex.size(); }
+
+    TagSet Match(std::string_view text) const {
+        TagSet tags;
+        TagSet guardedHits;
+        TagSet exclusionHits;
+        bool guarded = false;
+        uint16_t state = 0;
+        auto step = [&](uint8_t cls) {
+            state = next[state * kAlphabet + cls];
+            if (uint16_t index = outputIndex[state]) {
+                const TagRuleOutput& output = outputs[index];
+                tags |= output.tags;
+                if (!output.guardedHits.Empty() || !output.exclusionHits.Empty()) {
+                    guardedHits |= output.guardedHits;
+                    exclusionHits |= output.exclusionHits;
+                    guarded = true;
+                }
+            }
+        };
+
+        step(kBoundary);
+        for (char c : text) {
+            step(charClass[static_cast<uint8_t>(c)]);
+        }
+        step(kBoundary);
+
+        if (guarded) {
+            guardedHits.ForEach([&](uint32_t rule) {
+                if (!exclusionHits.Has(rule)) {
+                    tags.Add(guardedTags[rule]);
+                }
+            });
+        }
+        return tags;
+    }
+};
+
+// Compiles the [Rules] section of a tag rules file. internTag maps a tag name to its TagSet ID, or
+// kInvalidTagID when none is free; log receives skipped-line warnings and the summary. Returns
+// nullptr when no rule is valid, so the caller keeps whatever rules it had.
+template <typename InternTag, typename Log>
+std::shared_ptr<const TagRuleAutomaton> CompileTagRules(std::istream& in, InternTag&& internTag, Log&& log) {
+    constexpr size_t kAlphabet = TagRuleAutomaton::kAlphabet;
+    constexpr uint8_t kBoundary = TagRuleAutomaton::kBoundary;
+
+    auto automaton = std::make_shared<TagRuleAutomaton>();
+    for (int c = 'a'; c <= 'z'; c++) {
+        automaton->charClass[c] = static_cast<uint8_t>(c - 'a' + 1);
+        automaton->charClass[c - 'a' + 'A'] = static_cast<uint8_t>(c - 'a' + 1);
+    }
+
+    std::vector<std::array<int32_t, kAlphabet>> trie(1);
+    trie[0].fill(-1);
+    std::vector<TagRuleOutput> stateOutputs(1);
+
+    auto trim = [](std::string text) {
+        text.erase(0, text.find_first_not_of(" \t\r\n"));
+        text.erase(text.find_last_not_of(" \t\r\n") + 1);
+        return text;
+    };
+    auto lower = [](std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return text;
+    };
+    auto isWord = [](const std::string& text) {
+        return !text.empty() &&
+               std::all_of(text.begin(), text.end(), [](unsigned char c) { return c >= 'a' && c <= 'z'; });
+    };
+    auto insert = [&](const std::string& keyword, bool wordStart, bool wordEnd) -> int32_t {
+        std::vector<uint8_t> symbols;
+        if (wordStart) {
+            symbols.push_back(kBoundary);
+        }
+        for (char c : keyword) {
+            symbols.push_back(automaton->charClass[static_cast<uint8_t>(c)]);
+        }
+        if (wordEnd) {
+            symbols.push_back(kBoundary);
+        }
+
+        size_t state = 0;
+        for (uint8_t cls : symbols) {
+            if (trie[state][cls] < 0) {
+                if (trie.size() >= TagRuleAutomaton::kMaxStates) {
+                    return -1;
+                }
+                trie[state][cls] = static_cast<int32_t>(trie.size());
+                trie.emplace_back().fill(-1);
+                stateOutputs.emplace_back();
+            }
+            state = static_cast<size_t>(trie[state][cls]);
+        }
+        return static_cast<int32_t>(state);
+    };
+
+    std::string line;
+    std::string currentSection;
+    int lineNumber = 0;
+    size_t skipped = 0;
+
+    while (std::getline(in, line)) {
+        lineNumber++;
+        line = trim(line);
+        if (line.empty() || line[0] == ';' || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[' && line[line.length() - 1] == ']') {
+            currentSection = line.substr(1, line.length() - 2);
+            continue;
+        }
+        if (currentSection != "Rules") {
+            continue;
+        }
+
+        size_t equalPos = line.find('=');
+        if (equalPos == std::string::npos) {
+            log("Tag rules line " + std::to_string(lineNumber) + ": missing '='");
+            skipped++;
+            continue;
+        }
+
+        std::string keyword = lower(trim(line.substr(0, equalPos)));
+        std::vector<std::string> fields;
+        std::stringstream ss(line.substr(equalPos + 1));
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            field = trim(field);
+            if (!field.empty()) {
+                fields.push_back(field);
+            }
+        }
+
+        if (!isWord(keyword) || fields.empty()) {
+            log("Tag rules line " + std::to_string(lineNumber) + ": keyword must be letters only and have a tag");
+            skipped++;
+            continue;
+        }
+
+        uint32_t tagID = internTag(fields[0]);
+        if (tagID == kInvalidTagID) {
+            log("Tag rules line " + std::to_string(lineNumber) + ": tag table full, rule skipped");
+            skipped++;
+            continue;
+        }
+
+        bool wordStart = false;
+        bool wordEnd = false;
+        std::vector<std::string> exclusions;
+        bool valid = true;
+        for (size_t i = 1; i < fields.size(); i++) {
+            std::string option = lower(fields[i]);
+            if (option == "word") {
+                wordStart = true;
+                wordEnd = true;
+            } else if (option == "prefix") {
+                wordStart = true;
+            } else if (option == "suffix") {
+                wordEnd = true;
+            } else if (option[0] == '!' && isWord(option.substr(1))) {
+                exclusions.push_back(option.substr(1));
+            } else {
+                log("Tag rules line " + std::to_string(lineNumber) + ": unknown option '" + fields[i] + "'");
+                valid = false;
+            }
+        }
+        if (!valid) {
+            skipped++;
+            continue;
+        }
+        if (!exclusions.empty() && automaton->guardedTags.size() >= TagRuleAutomaton::kMaxGuardedRules) {
+            log("Tag rules line " + std::to_string(lineNumber) + ": too many rules with exclusions, rule skipped");
+            skipped++;
+            continue;
+        }
+
+        int32_t keywordState = insert(keyword, wordStart, wordEnd);
+        std::vector<int32_t> exclusionStates;
+        for (const auto& exclusion : exclusions) {
+            exclusionStates.push_back(insert(exclusion, false, false));
+        }
+        if (keywordState < 0 || std::find(exclusionStates.begin(), exclusionStates.end(), -1) != exclusionStates.end()) {
+            log("Tag rules: automaton state limit reached at line " + std::to_string(lineNumber));
+            break;
+        }
+
+        if (exclusions.empty()) {
+            stateOutputs[keywordState].tags.Add(tagID);
+        } else {
+            uint32_t guardedRule = static_cast<uint32_t>(automaton->guardedTags.size());
+            automaton->guardedTags.push_back(tagID);
+            stateOutputs[keywordState].guardedHits.Add(guardedRule);
+            for (int32_t state : exclusionStates) {
+                stateOutputs[state].exclusionHits.Add(guardedRule);
+            }
+        }
+        automaton->ruleCount++;
+    }
+
+    if (automaton->ruleCount == 0) {
+        log("Tag rules file has no valid rules, keeping current rules");
+        return nullptr;
+    }
+
+    size_t stateCount = trie.size();
+    automaton->next.assign(stateCount * kAlphabet, 0);
+    std::vector<uint16_t> fail(stateCount, 0);
+    std::vector<uint16_t> queue;
+    queue.reserve(stateCount);
+    for (size_t cls = 0; cls < kAlphabet; cls++) {
+        if (trie[0][cls] >= 0) {
+            uint16_t child = static_cast<uint16_t>(trie[0][cls]);
+            automaton->next[cls] = child;
+            queue.push_back(child);
+        }
+    }
+    for (size_t head = 0; head < queue.size(); head++) {
+        uint16_t state = queue[head];
+        const TagRuleOutput& inherited = stateOutputs[fail[state]];
+        stateOutputs[state].tags |= inherited.tags;
+        stateOutputs[state].guardedHits |= inherited.guardedHits;
+        stateOutputs[state].exclusionHits |= inherited.exclusionHits;
+        for (size_t cls = 0; cls < kAlphabet; cls++) {
+            uint16_t fallback = automaton->next[fail[state] * kAlphabet + cls];
+            if (trie[state][cls] >= 0) {
+                uint16_t child = static_cast<uint16_t>(trie[state][cls]);
+                fail[child] = fallback;
+                automaton->next[state * kAlphabet + cls] = child;
+                queue.push_back(child);
+            } else {
+                automaton->next[state * kAlphabet + cls] = fallback;
+            }
+        }
+    }
+
+    automaton->outputIndex.assign(stateCount, 0);
+    automaton->outputs.emplace_back();
+    for (size_t state = 0; state < stateCount; state++) {
+        const TagRuleOutput& output = stateOutputs[state];
+        if (!output.tags.Empty() || !output.guardedHits.Empty() || !output.exclusionHits.Empty()) {
+            automaton->outputIndex[state] = static_cast<uint16_t>(automaton->outputs.size());
+            automaton->outputs.push_back(output);
+        }
+    }
+
+    log("Compiled tag rules: " + std::to_string(automaton->ruleCount) + " rules, " + std::to_string(stateCount) +
+        " states, " + std::to_string(skipped) + " skipped");
+    return automaton;
+}
+
+// Position and intensity labels derived from the known scene tags, first match wins.
+inline const char* GetScenePositionName(const TagSet& tags) {
+    for (uint64_t positionTag : {kSceneTagStanding, kSceneTagSitting, kSceneTagLying, kSceneTagDoggy, kSceneTagMissionary}) {
+        if (tags.HasAny(positionTag)) {
+            return kSceneTagNames[std::countr_zero(positionTag)];
+        }
+    }
+    return "Unknown";
+}
+
+inline const char* GetSceneIntensityName(const TagSet& tags) {
+    if (tags.HasAny(kSceneTagRough)) {
+        return "High";
+    }
+    if (tags.HasAny(kSceneTagGentle)) {
+        return "Low";
+    }
+    if (tags.HasAny(kSceneTagAggressive)) {
+        return "High";
+    }
+    return "Normal";
+}
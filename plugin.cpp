@@ -1,27 +1,47 @@
 ﻿#include <RE/Skyrim.h>
 #include <SKSE/SKSE.h>
+#include <intrin.h>
 #include <shlobj.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <windows.h>
 
 #include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <charconv>
 #include <chrono>
+#include <cmath>
 #include <ctime>
 #include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iomanip>
+#include <list>
 #include <map>
 #include <mutex>
+#include <random>
+#include <span>
+#include <spanstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include <optional>
 #include <memory>
 
+#include "ActorGrid.h"
+#include "SceneStateMachine.h"
+#include "SceneTags.h"
+#include "OStimJsonReader.h"
+#include "OStimLogScanner.h"
+
 namespace fs = std::filesystem;
 namespace logger = SKSE::log;
 
@@ -36,6 +56,27 @@ enum class SpellSystemType {
     BloodyNose
 };
 
+enum class SceneInputSource : uint8_t {
+    OStimLog,
+    ModEvent,
+    Monitor
+};
+
+enum class OStimEventType : uint8_t {
+    Unknown,
+    Prestart,
+    ThreadStart,
+    SceneChanged,
+    ThreadSceneChanged,
+    ThreadSpeedChanged,
+    Orgasm,
+    ActorOrgasm,
+    End,
+    TotalEnd,
+    ThreadEnd,
+    Count
+};
+
 struct PluginConfig {
     struct {
         bool enabled = true;
@@ -333,6 +374,13 @@ struct PluginConfig {
     struct {
         bool enabled = true;
     } notification;
+
+    struct {
+        bool enabled = false;
+        std::string file = "OStim-replay.log";
+        bool realtime = false;
+        std::string payloadFile = "OStim-payloads.log";
+    } replay;
 };
 
 struct CapturedNPCData {
@@ -373,98 +421,507 @@ struct CachedFactionIDs {
     bool resolved = false;
 };
 
+struct ActorClassForms {
+    RE::TESFaction* vampireFaction = nullptr;
+    RE::TESFaction* werewolfFaction = nullptr;
+    bool resolved = false;
+};
+
+enum ActorClassFlag : uint8_t {
+    kActorClassVampire = 1 << 0,
+    kActorClassWerewolf = 1 << 1,
+};
+
+// Vampire/werewolf classification per persistent ref FormID. Faction changes raise no event, so the
+// cache is cleared at every scene start; race switches and save loads also drop entries.
+struct ActorClassCache {
+    bool Find(RE::FormID refID, uint8_t& flags) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(refID);
+        if (it == entries.end()) {
+            return false;
+        }
+        flags = it->second;
+        return true;
+    }
+
+    void Store(RE::FormID refID, uint8_t flags) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries[refID] = flags;
+    }
+
+    void Invalidate(RE::FormID refID) {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.erase(refID);
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.clear();
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<RE::FormID, uint8_t> entries;
+};
+
 struct OStimEventData {
     std::string eventType;
     std::string sceneID;
     std::string actorName;
     int threadID = 0;
     int speed = -1;
-    std::vector<std::string> tags;
+    TagSet tags;
     std::chrono::steady_clock::time_point timestamp;
 };
 
 struct AnimationTagInfo {
     std::string animationName;
-    std::vector<std::string> implicitTags;
+    TagSet implicitTags;
     std::string position;
     std::string intensity;
     std::chrono::steady_clock::time_point detectedTime;
 };
 
+struct QueuedModEvent {
+    OStimEventType type = OStimEventType::Unknown;
+    RE::BSFixedString eventName;
+    RE::BSFixedString strArg;
+    float numArg = 0.0f;
+    RE::FormID senderFormID = 0;
+    std::chrono::steady_clock::time_point receivedTime;
+};
+
+struct OStimEventNameTable {
+    struct Entry {
+        RE::BSFixedString name;
+        OStimEventType type;
+    };
+
+    OStimEventNameTable()
+        : entries{{{"ostim_prestart", OStimEventType::Prestart},
+                   {"ostim_thread_start", OStimEventType::ThreadStart},
+                   {"ostim_thread_scenechanged", OStimEventType::ThreadSceneChanged},
+                   {"ostim_thread_speedchanged", OStimEventType::ThreadSpeedChanged},
+                   {"ostim_orgasm", OStimEventType::Orgasm},
+                   {"ostim_actor_orgasm", OStimEventType::ActorOrgasm},
+                   {"ostim_end", OStimEventType::End},
+                   {"ostim_totalend", OStimEventType::TotalEnd},
+                   {"ostim_thread_end", OStimEventType::ThreadEnd}}} {}
+
+    static const OStimEventNameTable& Get() {
+        static const OStimEventNameTable table;
+        return table;
+    }
+
+    // BSFixedString pooling already makes the exact-name lookup case-insensitive; the prefix
+    // checks fold case by hand to match it.
+    static bool StartsWithNoCase(const char* raw, std::string_view prefix) {
+        for (size_t i = 0; i < prefix.size(); i++) {
+            char c = raw[i];
+            if (c >= 'A' && c <= 'Z') {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+            if (c != prefix[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool IsOStimEvent(const RE::BSFixedString& eventName) {
+        const char* raw = eventName.data();
+        return raw && StartsWithNoCase(raw, "ostim_");
+    }
+
+    OStimEventType Classify(const RE::BSFixedString& eventName) const {
+        if (!IsOStimEvent(eventName)) {
+            return OStimEventType::Unknown;
+        }
+
+        const char* raw = eventName.data();
+        for (const auto& entry : entries) {
+            if (entry.name.data() == raw) {
+                return entry.type;
+            }
+        }
+
+        if (StartsWithNoCase(raw + 6, "scenechanged_")) {
+            return OStimEventType::SceneChanged;
+        }
+
+        return OStimEventType::Unknown;
+    }
+
+    std::array<Entry, 9> entries;
+};
+
+struct ModEventQueue {
+    static constexpr size_t kCapacity = 1024;
+    static constexpr size_t kMask = kCapacity - 1;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        QueuedModEvent event;
+    };
+
+    ModEventQueue() {
+        for (size_t i = 0; i < kCapacity; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    bool TryEnqueue(const QueuedModEvent& event) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & kMask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->event = event;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryDequeue(QueuedModEvent& event) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell = &cells[pos & kMask];
+        size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) != 0) {
+            return false;
+        }
+        dequeuePos.store(pos + 1, std::memory_order_relaxed);
+        event = std::move(cell->event);
+        cell->event = QueuedModEvent{};
+        cell->sequence.store(pos + kCapacity, std::memory_order_release);
+        return true;
+    }
+
+    size_t ApproximateDepth() const {
+        size_t head = enqueuePos.load(std::memory_order_relaxed);
+        size_t tail = dequeuePos.load(std::memory_order_relaxed);
+        return head >= tail ? head - tail : 0;
+    }
+
+    std::array<Cell, kCapacity> cells;
+    alignas(64) std::atomic<size_t> enqueuePos{0};
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+};
+
+// Log-linear histogram: each power of two is split into 2^SubBucketBits linear sub-buckets, and
+// values at or above 2^MaxValueBits land in the last bucket. With no sub-buckets it is a plain
+// log2 histogram whose percentiles are upper bounds.
+template <unsigned SubBucketBits = 0, unsigned MaxValueBits = 64>
+struct Log2Histogram {
+    static constexpr uint64_t kSubBucketCount = uint64_t(1) << SubBucketBits;
+    static constexpr size_t kBucketCount = (MaxValueBits - SubBucketBits + 1) * kSubBucketCount;
+
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets{};
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maxValue{0};
+
+    static size_t BucketIndex(uint64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        unsigned long highBit;
+        _BitScanReverse64(&highBit, value);
+        unsigned shift = highBit - SubBucketBits;
+        size_t index = shift * kSubBucketCount + static_cast<size_t>(value >> shift);
+        return index < kBucketCount ? index : kBucketCount - 1;
+    }
+
+    static uint64_t BucketUpperBound(size_t index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        unsigned shift = static_cast<unsigned>(index / kSubBucketCount) - 1;
+        uint64_t subBucket = index % kSubBucketCount + kSubBucketCount;
+        return shift + SubBucketBits >= 63 ? UINT64_MAX : ((subBucket + 1) << shift) - 1;
+    }
+
+    void Record(uint64_t value) {
+        buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        uint64_t previousMax = maxValue.load(std::memory_order_relaxed);
+        while (value > previousMax &&
+               !maxValue.compare_exchange_weak(previousMax, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t Percentile(double percentile) const {
+        uint64_t total = count.load(std::memory_order_relaxed);
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(total * percentile);
+        if (target >= total) {
+            target = total - 1;
+        }
+        uint64_t seen = 0;
+        for (size_t i = 0; i < buckets.size(); i++) {
+            seen += buckets[i].load(std::memory_order_relaxed);
+            if (seen > target) {
+                return (std::min)(BucketUpperBound(i), maxValue.load(std::memory_order_relaxed));
+            }
+        }
+        return maxValue.load(std::memory_order_relaxed);
+    }
+
+    std::string Summary() const {
+        uint64_t total = count.load(std::memory_order_relaxed);
+        uint64_t mean = total > 0 ? sum.load(std::memory_order_relaxed) / total : 0;
+        return "count=" + std::to_string(total) + " mean=" + std::to_string(mean) +
+               " p50<=" + std::to_string(Percentile(0.50)) + " p90<=" + std::to_string(Percentile(0.90)) +
+               " p99<=" + std::to_string(Percentile(0.99)) + " p99.9<=" + std::to_string(Percentile(0.999)) +
+               " max=" + std::to_string(maxValue.load(std::memory_order_relaxed));
+    }
+
+    void Reset() {
+        for (auto& bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        maxValue.store(0, std::memory_order_relaxed);
+    }
+};
+
+enum class LatencyStage : uint8_t {
+    Received,
+    Dequeued,
+    RulesEvaluated,
+    TaskQueued,
+    TaskExecuted,
+    Count
+};
+
+enum class LatencyInterval : uint8_t {
+    QueueWait,
+    RulesEvaluation,
+    TaskQueueing,
+    TaskExecution,
+    EndToEnd,
+    Count
+};
+
+constexpr size_t kLatencySourceOStimLog = static_cast<size_t>(OStimEventType::Count);
+constexpr size_t kLatencySourceCount = kLatencySourceOStimLog + 1;
+
+// 16 sub-buckets per power of two keep latency percentiles within ~6%; nanosecond values above ~4 s
+// share the last bucket.
+using LatencyHistogram = Log2Histogram<4, 32>;
+
+struct LatencyTrace {
+    size_t source = kLatencySourceOStimLog;
+    std::array<std::chrono::steady_clock::time_point, static_cast<size_t>(LatencyStage::Count)> stamps{};
+
+    void Mark(LatencyStage stage, std::chrono::steady_clock::time_point when = std::chrono::steady_clock::now()) {
+        stamps[static_cast<size_t>(stage)] = when;
+    }
+};
+
+// A mod event as the worker handles it: strArg is parsed once at dequeue and the payload travels
+// with the event. The payload's views point into strArg, which the event keeps alive.
+struct ParsedModEvent : QueuedModEvent {
+    OStimEventPayload payload;
+    bool hasPayload = false;
+};
+
+enum SceneFlag : uint16_t {
+    kSceneFlagNone = 0,
+    kSceneFlagTransition = 1 << 0
+};
+
+constexpr std::array<const char*, 9> kSceneFurnitureNames = {
+    "none", "bed", "bench", "chair", "table", "shelf", "wall", "cookingpot", "other"};
+
+constexpr uint32_t kSceneIndexMagic = 0x4953524F;
+constexpr uint32_t kSceneIndexVersion = 1;
+
+struct SceneIndexHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t fileCount;
+    uint32_t directoryBits;
+    uint32_t reserved;
+};
+
+struct SceneIndexEntry {
+    uint64_t idHash;
+    uint64_t tagBits;
+    uint8_t actorCount;
+    uint8_t furniture;
+    uint16_t flags;
+    uint32_t reserved;
+};
+
+struct SceneIndexFileRecord {
+    uint64_t pathHash;
+    uint64_t size;
+    int64_t writeTime;
+    uint64_t idHash;
+};
+
+struct SceneIndexView {
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+    const uint8_t* mappedBase = nullptr;
+    std::vector<uint8_t> owned;
+
+    const SceneIndexHeader* header = nullptr;
+    const uint32_t* directory = nullptr;
+    const SceneIndexEntry* entries = nullptr;
+    const SceneIndexFileRecord* files = nullptr;
+
+    SceneIndexView() = default;
+    SceneIndexView(const SceneIndexView&) = delete;
+    SceneIndexView& operator=(const SceneIndexView&) = delete;
+
+    ~SceneIndexView() {
+        if (mappedBase) {
+            UnmapViewOfFile(mappedBase);
+        }
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+    }
+
+    static size_t DirectoryOffset() { return sizeof(SceneIndexHeader); }
+
+    static size_t EntriesOffset(uint32_t directoryBits) {
+        size_t end = DirectoryOffset() + ((size_t(1) << directoryBits) + 1) * sizeof(uint32_t);
+        return (end + 7) & ~size_t(7);
+    }
+
+    bool Bind(const uint8_t* base, size_t size) {
+        if (size < sizeof(SceneIndexHeader)) {
+            return false;
+        }
+        auto* candidate = reinterpret_cast<const SceneIndexHeader*>(base);
+        if (candidate->magic != kSceneIndexMagic || candidate->version != kSceneIndexVersion ||
+            candidate->directoryBits > 24) {
+            return false;
+        }
+        size_t entriesOffset = EntriesOffset(candidate->directoryBits);
+        size_t filesOffset = entriesOffset + size_t(candidate->entryCount) * sizeof(SceneIndexEntry);
+        if (filesOffset + size_t(candidate->fileCount) * sizeof(SceneIndexFileRecord) > size) {
+            return false;
+        }
+        // Find trusts the directory to bound every bucket inside entries[].
+        auto* candidateDirectory = reinterpret_cast<const uint32_t*>(base + DirectoryOffset());
+        size_t bucketCount = size_t(1) << candidate->directoryBits;
+        for (size_t i = 0; i < bucketCount; i++) {
+            if (candidateDirectory[i] > candidateDirectory[i + 1]) {
+                return false;
+            }
+        }
+        if (candidateDirectory[bucketCount] > candidate->entryCount) {
+            return false;
+        }
+        header = candidate;
+        directory = reinterpret_cast<const uint32_t*>(base + DirectoryOffset());
+        entries = reinterpret_cast<const SceneIndexEntry*>(base + entriesOffset);
+        files = reinterpret_cast<const SceneIndexFileRecord*>(base + filesOffset);
+        return true;
+    }
+
+    const SceneIndexEntry* Find(uint64_t idHash) const {
+        if (!header || header->entryCount == 0) {
+            return nullptr;
+        }
+        uint64_t bucket = header->directoryBits == 0 ? 0 : idHash >> (64 - header->directoryBits);
+        for (uint32_t i = directory[bucket]; i < directory[bucket + 1]; i++) {
+            if (entries[i].idHash == idHash) {
+                return &entries[i];
+            }
+        }
+        return nullptr;
+    }
+};
+
+static std::atomic<std::shared_ptr<const TagRuleAutomaton>> g_tagRuleAutomaton;
+
 struct TagAnalyzer {
-    static std::vector<std::string> ExtractTagsFromEventData(const SKSE::ModCallbackEvent* event) {
-        std::vector<std::string> tags;
+    static TagSet ExtractTagsFromEventData(const ParsedModEvent& event) {
+        TagSet keywordTags;
         
-        std::string eventName = event->eventName.c_str();
-        std::string strArg = (event->strArg.c_str() != nullptr && strlen(event->strArg.c_str()) > 0) 
-            ? std::string(event->strArg.c_str()) : "";
+        std::string_view strArg = event.strArg.c_str() != nullptr ? event.strArg.c_str() : "";
             
-        if (eventName.find("ostim_scenechanged_") == 0) {
-            std::string animName = eventName.substr(19);
-            auto animTags = ExtractTagsFromAnimationName(animName);
-            tags.insert(tags.end(), animTags.begin(), animTags.end());
+        if (event.type == OStimEventType::SceneChanged) {
+            keywordTags |= ExtractTagsFromAnimationName(event.eventName.c_str() + 19);
         }
         
-        if (!strArg.empty()) {
-            auto argTags = ExtractTagsFromAnimationName(strArg);
-            tags.insert(tags.end(), argTags.begin(), argTags.end());
+        if (event.hasPayload) {
+            const OStimEventPayload& payload = event.payload;
+            if (payload.tagCount == 0 && !payload.sceneID.empty()) {
+                keywordTags |= ExtractTagsFromAnimationName(payload.sceneID);
+            }
+            TagSet tags = keywordTags;
+            for (size_t i = 0; i < payload.tagCount; i++) {
+                tags.Add(TagNameTable::Get().Intern(payload.tags[i]));
+            }
+            if (payload.speed >= 3) tags.Add(kTagIDHighIntensity);
+            else if (payload.speed >= 2) tags.Add(kTagIDMediumIntensity);
+            else if (payload.speed >= 0) tags.Add(kTagIDLowIntensity);
+            if (event.type == OStimEventType::Orgasm || event.type == OStimEventType::ActorOrgasm) {
+                tags.Add(kTagIDClimax);
+            }
+            return tags;
         }
         
-        if (eventName == "ostim_thread_speedchanged") {
-            std::string speedStr = strArg;
+        keywordTags |= ExtractTagsFromAnimationName(strArg);
+        TagSet tags = keywordTags;
+        
+        if (event.type == OStimEventType::ThreadSpeedChanged) {
             try {
-                int speed = std::stoi(speedStr);
-                if (speed >= 3) tags.push_back("HighIntensity");
-                else if (speed >= 2) tags.push_back("MediumIntensity");
-                else tags.push_back("LowIntensity");
+                int speed = std::stoi(std::string(strArg));
+                if (speed >= 3) tags.Add(kTagIDHighIntensity);
+                else if (speed >= 2) tags.Add(kTagIDMediumIntensity);
+                else tags.Add(kTagIDLowIntensity);
             } catch (...) {}
         }
         
-        if (eventName == "ostim_orgasm" || eventName == "ostim_actor_orgasm") {
-            tags.push_back("Climax");
-            if (!strArg.empty()) {
-                auto climaxTags = ExtractTagsFromAnimationName(strArg);
-                tags.insert(tags.end(), climaxTags.begin(), climaxTags.end());
-            }
+        if (event.type == OStimEventType::Orgasm || event.type == OStimEventType::ActorOrgasm) {
+            tags.Add(kTagIDClimax);
         }
         
         return tags;
     }
     
-    static std::vector<std::string> ExtractTagsFromAnimationName(const std::string& animName) {
-        std::vector<std::string> tags;
-        std::string lower = animName;
-        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
-        
-        if (lower.find("standing") != std::string::npos) tags.push_back("Standing");
-        if (lower.find("sitting") != std::string::npos) tags.push_back("Sitting");
-        if (lower.find("lying") != std::string::npos || lower.find("laying") != std::string::npos) tags.push_back("Lying");
-        if (lower.find("doggy") != std::string::npos || lower.find("behind") != std::string::npos) tags.push_back("Doggy");
-        if (lower.find("missionary") != std::string::npos || lower.find("mating") != std::string::npos) tags.push_back("Missionary");
-        
-        if (lower.find("oral") != std::string::npos || lower.find("bj") != std::string::npos || 
-            lower.find("blowjob") != std::string::npos) tags.push_back("Oral");
-        if (lower.find("vaginal") != std::string::npos || lower.find("penetration") != std::string::npos) tags.push_back("Vaginal");
-        if (lower.find("anal") != std::string::npos) tags.push_back("Anal");
-        if (lower.find("kiss") != std::string::npos) tags.push_back("Kissing");
-        if (lower.find("touch") != std::string::npos || lower.find("caress") != std::string::npos) tags.push_back("Touching");
-        
-        if (lower.find("rough") != std::string::npos || lower.find("hard") != std::string::npos) tags.push_back("Rough");
-        if (lower.find("gentle") != std::string::npos || lower.find("soft") != std::string::npos) tags.push_back("Gentle");
-        if (lower.find("aggressive") != std::string::npos || lower.find("dom") != std::string::npos) tags.push_back("Aggressive");
-        
-        if (lower.find("close") != std::string::npos) tags.push_back("Intimate");
-        if (lower.find("approach") != std::string::npos || lower.find("goto") != std::string::npos) tags.push_back("Transition");
-        if (lower.find("spread") != std::string::npos) tags.push_back("Spread");
-        if (lower.find("press") != std::string::npos) tags.push_back("Pressing");
-        if (lower.find("oare") != std::string::npos) tags.push_back("OARE");
-        
-        return tags;
+    static TagSet ExtractTagsFromAnimationName(std::string_view animName) {
+        if (auto rules = g_tagRuleAutomaton.load(std::memory_order_acquire)) {
+            return rules->Match(animName);
+        }
+        return TagSet::FromBits(kTagKeywordAutomaton.Match(animName));
+    }
+
+    static uint32_t ExtractTagMaskFromAnimationName(std::string_view animName) {
+        return kTagKeywordAutomaton.Match(animName);
     }
 };
 
+constexpr uint32_t kInvalidActorNameID = 0xFFFFFFFF;
+
 struct ActorInfo {
     std::string name;
+    uint32_t nameID = kInvalidActorNameID;
     RE::FormID refID = 0;
     RE::FormID baseID = 0;
     std::string race;
@@ -472,93 +929,583 @@ struct ActorInfo {
     bool isVampire = false;
     bool isWerewolf = false;
     bool captured = false;
+
+    // Shared by the live capture and the world snapshot so both fill the same fields the same way.
+    static ActorInfo FromForms(const char* name, uint32_t nameID, RE::FormID refID, RE::FormID baseID, const char* race,
+                               bool female, uint8_t classFlags) {
+        ActorInfo info;
+        info.name = name;
+        info.nameID = nameID;
+        info.refID = refID;
+        info.baseID = baseID;
+        info.race = race;
+        info.gender = female ? "Female" : "Male";
+        info.isVampire = (classFlags & kActorClassVampire) != 0;
+        info.isWerewolf = (classFlags & kActorClassWerewolf) != 0;
+        info.captured = true;
+        return info;
+    }
 };
 
-struct ActiveSpellEffect {
-    RE::FormID actorFormID;
-    std::string actorName;
-    bool isPlayer;
-    bool isNPCCast;
-    std::string gender;
-    std::chrono::steady_clock::time_point activationTime;
-    int durationSeconds;
-    bool manuallyDeactivated = false;
-    bool isTagBased = false;
-    bool spellActivated = false;
-    bool spellDeactivated = false;
-    std::vector<std::string> activeTags;
-    std::string activeAnimationName;
-    SpellSystemType systemType = SpellSystemType::EmotionalTears;
+struct TransparentStringHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
 };
 
-struct ActorOrgasmCounter {
-    RE::FormID actorFormID;
-    std::string actorName;
-    bool isPlayer;
-    std::string gender;
-    int orgasmCount = 0;
+// Interned actor names. Each distinct spelling is normalized once - trimmed, re-encoded to UTF-8
+// when it is not valid UTF-8 (legacy ANSI plugin strings), and lowercased with the invariant
+// locale - and spellings that normalize alike share one ID, so name equality is an integer compare.
+struct ActorNameTable {
+    static ActorNameTable& Get() {
+        static ActorNameTable table;
+        return table;
+    }
+
+    uint32_t Intern(std::string_view name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto spelling = spellings.find(name);
+        if (spelling != spellings.end()) {
+            return spelling->second;
+        }
+        std::string normalized = Normalize(name);
+        auto [it, inserted] = ids.try_emplace(normalized, static_cast<uint32_t>(names.size()));
+        if (inserted) {
+            names.push_back(std::move(normalized));
+        }
+        spellings.emplace(std::string(name), it->second);
+        return it->second;
+    }
+
+    // Unlike Intern, never adds a name: a spelling whose normalized form is unknown cannot match
+    // any actor that was ever captured.
+    uint32_t Find(std::string_view name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto spelling = spellings.find(name);
+        if (spelling != spellings.end()) {
+            return spelling->second;
+        }
+        auto it = ids.find(Normalize(name));
+        if (it == ids.end()) {
+            return kInvalidActorNameID;
+        }
+        spellings.emplace(std::string(name), it->second);
+        return it->second;
+    }
+
+    std::string Name(uint32_t nameID) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return nameID < names.size() ? names[nameID] : std::string();
+    }
+
+    size_t Size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return names.size();
+    }
+
+    static std::string Normalize(std::string_view name) {
+        size_t begin = name.find_first_not_of(" \t\r\n");
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        name = name.substr(begin, name.find_last_not_of(" \t\r\n") - begin + 1);
+
+        if (std::all_of(name.begin(), name.end(), [](unsigned char c) { return c < 0x80; })) {
+            std::string folded(name);
+            for (char& c : folded) {
+                if (c >= 'A' && c <= 'Z') {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+            }
+            return folded;
+        }
+
+        int length = static_cast<int>(name.size());
+        UINT codePage = CP_UTF8;
+        int wideLength = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, name.data(), length, nullptr, 0);
+        if (wideLength <= 0) {
+            codePage = CP_ACP;
+            wideLength = MultiByteToWideChar(CP_ACP, 0, name.data(), length, nullptr, 0);
+            if (wideLength <= 0) {
+                return std::string(name);
+            }
+        }
+        std::wstring wide(wideLength, L'\0');
+        MultiByteToWideChar(codePage, 0, name.data(), length, wide.data(), wideLength);
+
+        int foldedLength = LCMapStringEx(LOCALE_NAME_INVARIANT, LCMAP_LOWERCASE, wide.data(), wideLength, nullptr, 0,
+                                         nullptr, nullptr, 0);
+        if (foldedLength > 0) {
+            std::wstring folded(foldedLength, L'\0');
+            if (LCMapStringEx(LOCALE_NAME_INVARIANT, LCMAP_LOWERCASE, wide.data(), wideLength, folded.data(),
+                              foldedLength, nullptr, nullptr, 0) > 0) {
+                wide = std::move(folded);
+            }
+        }
+
+        int utf8Length = WideCharToMultiByte(CP_UTF8, 0, wide.data(), static_cast<int>(wide.size()), nullptr, 0, nullptr, nullptr);
+        if (utf8Length <= 0) {
+            return std::string(name);
+        }
+        std::string result(utf8Length, '\0');
+        WideCharToMultiByte(CP_UTF8, 0, wide.data(), static_cast<int>(wide.size()), result.data(), utf8Length, nullptr, nullptr);
+        return result;
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t, TransparentStringHash, std::equal_to<>> spellings;
+    std::unordered_map<std::string, uint32_t> ids;
+    std::vector<std::string> names;
 };
 
-struct BloodyNoseCounter {
-    RE::FormID actorFormID;
-    std::string actorName;
-    bool isPlayer;
-    std::string gender;
-    int orgasmCount = 0;
-    bool spellActive = false;
-    std::chrono::steady_clock::time_point spellActivationTime;
+constexpr float kMilkNPCDetectionRadius = 500.0f;
+constexpr float kNPCRefIDSearchRadius = 1000.0f;
+constexpr float kSceneNPCCacheRadius = 3000.0f;
+// Monitor ticks (one per second) after which a world snapshot no longer answers proximity queries.
+constexpr uint64_t kWorldSnapshotMaxAgeTicks = 3;
+
+// FormID prefix of one loaded plugin. Full plugins own the top byte; light plugins share 0xFE and
+// are told apart by the next twelve bits, leaving only 0xFFF for their local IDs.
+struct PluginPrefix {
+    RE::FormID prefix = 0;
+    RE::FormID mask = 0;
+    bool light = false;
+
+    bool Contains(RE::FormID formID) const { return (formID & mask) == prefix; }
+    RE::FormID Compose(RE::FormID localID) const { return prefix | (localID & ~mask); }
 };
 
-struct PendingSpellCast {
-    RE::FormID rawActorFormID;
-    RE::FormID spellFormID;
-    std::string actorName;
-    bool isPlayer;
-    bool isNPCCast;
-    std::chrono::steady_clock::time_point nextRetryTime;
-    int attemptsRemaining;
-    bool isTagBased;
-    std::string gender;
-    int durationSeconds;
-    SpellSystemType systemType;
+struct CaseInsensitiveHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view text) const {
+        size_t hash = 14695981039346656037ull;
+        for (unsigned char c : text) {
+            hash = (hash ^ static_cast<unsigned char>(std::tolower(c))) * 1099511628211ull;
+        }
+        return hash;
+    }
 };
 
-struct ActorSpellRecord {
-    std::string actorName;
-    RE::FormID actorFormID;
-    bool isNPCCast;
-    bool isActive;
-    std::chrono::steady_clock::time_point timestamp;
-    SpellSystemType systemType;
+struct CaseInsensitiveEqual {
+    using is_transparent = void;
+    bool operator()(std::string_view a, std::string_view b) const {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](unsigned char x, unsigned char y) {
+                   return std::tolower(x) == std::tolower(y);
+               });
+    }
 };
 
-static std::deque<std::string> g_actionLines;
-static std::deque<std::string> g_animationLines;
-static std::deque<std::string> g_ostimEventLines;
-static std::string g_documentsPath;
-static std::string g_gamePath;
-static bool g_isInitialized = false;
+// Load order resolved once at kDataLoaded, keyed by plugin file name without regard to case.
+struct PluginIndex {
+    std::unordered_map<std::string, PluginPrefix, CaseInsensitiveHash, CaseInsensitiveEqual> plugins;
+    size_t fullCount = 0;
+    size_t lightCount = 0;
+
+    const PluginPrefix* Find(std::string_view pluginName) const {
+        auto it = plugins.find(pluginName);
+        return it != plugins.end() ? &it->second : nullptr;
+    }
+
+    static std::shared_ptr<const PluginIndex> Build(RE::TESDataHandler* dataHandler) {
+        auto index = std::make_shared<PluginIndex>();
+        for (auto* file : dataHandler->compiledFileCollection.files) {
+            if (!file) continue;
+            PluginPrefix entry;
+            entry.prefix = static_cast<RE::FormID>(file->compileIndex) << 24;
+            entry.mask = 0xFF000000;
+            index->plugins.emplace(std::string(file->GetFilename()), entry);
+            index->fullCount++;
+        }
+        for (auto* file : dataHandler->compiledFileCollection.smallFiles) {
+            if (!file) continue;
+            PluginPrefix entry;
+            entry.prefix = 0xFE000000 | (static_cast<RE::FormID>(file->smallFileCompileIndex & 0xFFF) << 12);
+            entry.mask = 0xFFFFF000;
+            entry.light = true;
+            index->plugins.emplace(std::string(file->GetFilename()), entry);
+            index->lightCount++;
+        }
+        return index;
+    }
+};
+
+struct ActorFilter {
+    RE::FormID prefix = 0;
+    RE::FormID mask = 0;
+    RE::FormID baseID = 0;
+
+    static ActorFilter FromPlugin(const PluginPrefix& plugin) { return {plugin.prefix, plugin.mask, 0}; }
+    static ActorFilter ForBase(RE::FormID baseID) { return {0, 0, baseID}; }
+};
+
+// Loaded actors captured once per tick on the game thread, laid out as parallel arrays so the
+// proximity queries on the scene strand scan plain memory instead of the engine's process lists.
+// Order follows the high, middle-high and low process lists; the player is not in them and is
+// captured separately. tick is the monitor cycle the snapshot was captured in.
+struct WorldSnapshot {
+    uint64_t tick = 0;
+    RE::NiPoint3 playerPos;
+    ActorInfo player;
+    std::vector<RE::FormID> refIDs;
+    std::vector<RE::FormID> baseIDs;
+    std::vector<RE::NiPoint3> positions;
+    std::vector<uint8_t> female;
+    std::vector<uint32_t> nameIDs;
+    // Display names and class flags for building ActorInfo without touching the actor. The names
+    // are copied: leveled actors have temporary 0xFF bases that the engine frees and reuses.
+    std::vector<std::string> names;
+    std::vector<std::string> raceNames;
+    std::vector<uint8_t> classFlags;
+    ActorGrid<RE::NiPoint3> grid;
+
+    size_t Size() const { return refIDs.size(); }
+
+    ActorInfo ActorInfoAt(uint32_t i) const {
+        return ActorInfo::FromForms(names[i].c_str(), nameIDs[i], refIDs[i], baseIDs[i], raceNames[i].c_str(), female[i] != 0,
+                                    classFlags[i]);
+    }
+
+    static constexpr uint32_t kNotFound = 0xFFFFFFFF;
+
+    uint32_t FindRef(RE::FormID refID) const {
+        auto it = std::find(refIDs.begin(), refIDs.end(), refID);
+        return it != refIDs.end() ? static_cast<uint32_t>(it - refIDs.begin()) : kNotFound;
+    }
+
+    // Calls func(index) for each actor within radius of center that passes the filter, stopping
+    // early when func returns true.
+    template <typename Func>
+    bool ForEachInRadius(const RE::NiPoint3& center, float radius, const ActorFilter& filter, Func&& func) const {
+        return grid.ForEachInRadius(positions, center, radius, [&](uint32_t i) {
+            if ((baseIDs[i] & filter.mask) != filter.prefix || (filter.baseID != 0 && baseIDs[i] != filter.baseID)) {
+                return false;
+            }
+            return func(i);
+        });
+    }
+
+    template <typename Func>
+    bool ForEachNearPlayer(float radius, const ActorFilter& filter, Func&& func) const {
+        return ForEachInRadius(playerPos, radius, filter, std::forward<Func>(func));
+    }
+};
+
+// Actors keyed by ref FormID: a dense array in insertion order plus an open-addressing index of
+// dense positions. Names are indexed separately by interned name ID and may map to several
+// actors; name lookups return the closest one.
+class ActorTable {
+public:
+    using const_iterator = std::vector<ActorInfo>::const_iterator;
+
+    const_iterator begin() const { return actors.begin(); }
+    const_iterator end() const { return actors.end(); }
+    size_t size() const { return actors.size(); }
+    bool empty() const { return actors.empty(); }
+    const std::vector<ActorInfo>& Actors() const { return actors; }
+
+    void reserve(size_t count) {
+        actors.reserve(count);
+        distances.reserve(count);
+    }
+
+    void clear() {
+        actors.clear();
+        distances.clear();
+        slots.clear();
+        names.clear();
+    }
+
+    bool Insert(const ActorInfo& info, float distance = std::numeric_limits<float>::max()) {
+        if (Find(info.refID)) {
+            return false;
+        }
+        if ((actors.size() + 1) * 2 > slots.size()) {
+            Rehash(std::max<size_t>(16, slots.size() * 2));
+        }
+
+        uint32_t index = static_cast<uint32_t>(actors.size());
+        actors.push_back(info);
+        distances.push_back(distance);
+        slots[Probe(info.refID)] = index + 1;
+
+        ActorInfo& stored = actors.back();
+        if (stored.nameID == kInvalidActorNameID) {
+            stored.nameID = ActorNameTable::Get().Intern(stored.name);
+        }
+        names[stored.nameID].push_back(index);
+        return true;
+    }
+
+    const ActorInfo* Find(RE::FormID refID) const {
+        if (slots.empty()) {
+            return nullptr;
+        }
+        uint32_t slot = slots[Probe(refID)];
+        return slot ? &actors[slot - 1] : nullptr;
+    }
+
+    const ActorInfo* FindByName(std::string_view name, float* distance = nullptr) const {
+        return FindByNameID(ActorNameTable::Get().Find(name), distance);
+    }
+
+    const ActorInfo* FindByNameID(uint32_t nameID, float* distance = nullptr) const {
+        auto it = names.find(nameID);
+        if (it == names.end()) {
+            return nullptr;
+        }
+        uint32_t best = it->second.front();
+        for (uint32_t index : it->second) {
+            if (distances[index] < distances[best]) {
+                best = index;
+            }
+        }
+        if (distance) {
+            *distance = distances[best];
+        }
+        return &actors[best];
+    }
+
+private:
+    size_t Probe(RE::FormID refID) const {
+        size_t mask = slots.size() - 1;
+        size_t slot = (static_cast<size_t>(refID) * 0x9E3779B97F4A7C15ull >> 32) & mask;
+        while (slots[slot] != 0 && actors[slots[slot] - 1].refID != refID) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void Rehash(size_t capacity) {
+        slots.assign(capacity, 0);
+        for (uint32_t index = 0; index < actors.size(); index++) {
+            slots[Probe(actors[index].refID)] = index + 1;
+        }
+    }
+
+    std::vector<ActorInfo> actors;
+    std::vector<float> distances;
+    std::vector<uint32_t> slots;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> names;
+};
+
+struct SceneInput {
+    SceneInputKind kind;
+    SceneInputSource source;
+    std::chrono::steady_clock::time_point timestamp;
+    std::string animationName;
+};
+
+// Result of the prestart warm-up, which only does file I/O (the scene index refresh) off the strand.
+// Anything that reads engine forms or actors is left to the strand or the game-thread snapshot.
+struct SceneWarmup {
+    std::chrono::steady_clock::duration elapsed{};
+    bool preparedAtPrestart = false;
+};
+
+struct SceneSnapshot {
+    uint64_t version = 0;
+    bool inScene = false;
+    SceneState state = SceneState::Idle;
+    std::string lastAnimation;
+    AnimationTagInfo animationInfo;
+    ActorTable actors;
+    TagSet tags;
+    int speed = 0;
+    std::chrono::steady_clock::time_point sceneStartTime;
+};
+
+struct SceneAnalysis {
+    uint64_t idHash = 0;
+    uint32_t configVersion = 0;
+    uint32_t indexGeneration = 0;
+    bool valid = false;
+    TagSet tags;
+    std::string position;
+    std::string intensity;
+    uint8_t matchBits = 0;
+
+    static constexpr uint32_t MatchBit(SpellSystemType systemType, bool isPlayer) {
+        return static_cast<uint32_t>(systemType) * 2 + (isPlayer ? 1 : 0);
+    }
+
+    bool Matches(SpellSystemType systemType, bool isPlayer) const {
+        return (matchBits >> MatchBit(systemType, isPlayer)) & 1;
+    }
+};
+
+// Per-scene OStim tag and speed statistics, updated in O(1) per log line. Time accumulators are
+// folded in when a tag is cleared or the speed changes, so reports only read them.
+struct SceneTagStats {
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t kSpeedLevels = 8;
+
+    TagSet tags;
+    TagSet seenTags;
+    int speed = 0;
+    uint32_t tagEvents = 0;
+    uint32_t speedChanges = 0;
+    Clock::time_point speedSince{};
+    std::array<Clock::time_point, TagSet::kCapacity> tagSince{};
+    std::array<Clock::duration, TagSet::kCapacity> tagTime{};
+    std::array<Clock::duration, kSpeedLevels> speedTime{};
+
+    static size_t SpeedSlot(int level) { return static_cast<size_t>(std::clamp(level, 0, static_cast<int>(kSpeedLevels) - 1)); }
+
+    bool AddTag(uint32_t id, Clock::time_point now) {
+        if (id >= TagSet::kCapacity || tags.Has(id)) {
+            return false;
+        }
+        tags.Add(id);
+        seenTags.Add(id);
+        tagSince[id] = now;
+        tagEvents++;
+        return true;
+    }
+
+    void ClearTags(Clock::time_point now) {
+        tags.ForEach([&](uint32_t id) { tagTime[id] += now - tagSince[id]; });
+        tags.Clear();
+    }
+
+    bool SetSpeed(int newSpeed, Clock::time_point now) {
+        if (newSpeed == speed) {
+            return false;
+        }
+        speedTime[SpeedSlot(speed)] += now - speedSince;
+        speed = newSpeed;
+        speedSince = now;
+        speedChanges++;
+        return true;
+    }
+
+    void Reset(Clock::time_point now) {
+        tags.Clear();
+        seenTags.Clear();
+        speed = 0;
+        tagEvents = 0;
+        speedChanges = 0;
+        speedSince = now;
+        tagTime.fill(Clock::duration::zero());
+        speedTime.fill(Clock::duration::zero());
+    }
+
+    Clock::duration TagTime(uint32_t id, Clock::time_point now) const {
+        return tagTime[id] + (tags.Has(id) ? now - tagSince[id] : Clock::duration::zero());
+    }
+
+    Clock::duration SpeedTime(size_t slot, Clock::time_point now) const {
+        return speedTime[slot] + (SpeedSlot(speed) == slot ? now - speedSince : Clock::duration::zero());
+    }
+};
+
+struct OStimThreadState {
+    int threadID = 0;
+    std::mutex mutex;
+    std::vector<ActorInfo> actors;
+    AnimationTagInfo animationInfo;
+    int speed = 0;
+    int animationChanges = 0;
+    int orgasmCount = 0;
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::steady_clock::time_point lastChangeTime;
+};
+
+struct ActiveSpellEffect {
+    RE::FormID actorFormID;
+    std::string actorName;
+    bool isPlayer;
+    bool isNPCCast;
+    std::string gender;
+    std::chrono::steady_clock::time_point activationTime;
+    int durationSeconds;
+    bool manuallyDeactivated = false;
+    bool isTagBased = false;
+    bool spellActivated = false;
+    bool spellDeactivated = false;
+    TagSet activeTags;
+    std::string activeAnimationName;
+    SpellSystemType systemType = SpellSystemType::EmotionalTears;
+};
+
+struct ActorOrgasmCounter {
+    RE::FormID actorFormID;
+    std::string actorName;
+    bool isPlayer;
+    std::string gender;
+    int orgasmCount = 0;
+};
+
+struct BloodyNoseCounter {
+    RE::FormID actorFormID;
+    std::string actorName;
+    bool isPlayer;
+    std::string gender;
+    int orgasmCount = 0;
+    bool spellActive = false;
+    std::chrono::steady_clock::time_point spellActivationTime;
+};
+
+struct PendingSpellCast {
+    RE::FormID rawActorFormID;
+    RE::FormID spellFormID;
+    std::string actorName;
+    bool isPlayer;
+    bool isNPCCast;
+    std::chrono::steady_clock::time_point nextRetryTime;
+    int attemptsRemaining;
+    bool isTagBased;
+    std::string gender;
+    int durationSeconds;
+    SpellSystemType systemType;
+};
+
+struct ActorSpellRecord {
+    std::string actorName;
+    RE::FormID actorFormID;
+    bool isNPCCast;
+    bool isActive;
+    std::chrono::steady_clock::time_point timestamp;
+    SpellSystemType systemType;
+};
+
+struct LogChunkStats {
+    size_t bytesConsumed = 0;
+    size_t linesSeen = 0;
+    size_t linesProcessed = 0;
+};
+
+static std::deque<std::string> g_actionLines;
+static std::deque<std::string> g_animationLines;
+static std::deque<std::string> g_ostimEventLines;
+static std::string g_documentsPath;
+static std::string g_gamePath;
+static bool g_isInitialized = false;
 static std::mutex g_logMutex;
-static std::mutex g_sceneMutex;
 static std::mutex g_configMutex;
-static std::mutex g_effectsMutex;
 static std::mutex g_cacheMutex;
-static std::mutex g_orgasmMutex;
-static std::mutex g_orgasmCounterMutex;
-static std::mutex g_pendingSpellMutex;
-static std::mutex g_bloodyNoseCounterMutex;
+static ActorClassForms g_actorClassForms;
+static ActorClassCache g_actorClassCache;
+static bool g_nearbyNPCsCacheBuilt = false;
 static std::streampos g_lastOStimLogPosition = 0;
 static bool g_monitoringActive = false;
 static std::thread g_monitorThread;
-static int g_monitorCycles = 0;
+static std::atomic<uint64_t> g_monitorCycles(0);
 static std::unordered_set<std::string> g_processedLines;
 static size_t g_lastFileSize = 0;
 static std::string g_lastAnimation = "";
 static std::chrono::steady_clock::time_point g_monitoringStartTime;
 static bool g_initialDelayComplete = false;
+static bool g_catchUpComplete = false;
+static FindNewlineFunc g_findNextNewline = nullptr;
+static std::string g_ostimReadBuffer;
 static std::atomic<bool> g_isShuttingDown(false);
 static SKSELogsPaths g_ostimLogPaths;
 static PluginConfig g_config;
+static std::atomic<uint32_t> g_configVersion(0);
+static size_t g_configContentHash = 0;
+static std::thread g_tagRulesThread;
+static std::atomic<bool> g_tagRulesCompiling(false);
+static fs::file_time_type g_tagRulesWriteTime{};
 
 static bool g_inOStimScene = false;
 static std::chrono::steady_clock::time_point g_lastGoldRewardTime;
@@ -596,9 +1543,14 @@ static HANDLE g_directoryHandle = INVALID_HANDLE_VALUE;
 static std::thread g_fileWatchThread;
 static std::atomic<bool> g_fileWatchActive(false);
 
-static std::vector<std::string> g_detectedNPCNames;
-static std::map<std::string, RE::FormID> g_npcNameToRefID;
-static std::map<std::string, ActorInfo> g_nearbyNPCsCache;
+struct DetectedNPCName {
+    std::string name;
+    uint32_t nameID = kInvalidActorNameID;
+};
+
+static std::vector<DetectedNPCName> g_detectedNPCNames;
+static std::unordered_map<uint32_t, RE::FormID> g_npcNameToRefID;
+static ActorTable g_nearbyNPCsCache;
 static std::map<RE::FormID, std::chrono::steady_clock::time_point> g_lastOrgasmTimestamps;
 
 static std::vector<ActiveSpellEffect> g_activeSpellEffects;
@@ -607,14 +1559,15 @@ static std::vector<BloodyNoseCounter> g_bloodyNoseCounters;
 static std::vector<PendingSpellCast> g_pendingSpellCasts;
 
 static std::map<int, OStimEventData> g_currentOStimEvents;
-static int g_currentOStimSpeed = 0;
-static std::vector<std::string> g_currentOStimTags;
-static std::chrono::steady_clock::time_point g_lastOStimEventCheck;
+static SceneTagStats g_sceneTagStats;
 
 static AnimationTagInfo g_currentAnimationInfo;
-static std::vector<std::string> g_detectedTagsFromAnimation;
+static TagSet g_detectedTagsFromAnimation;
+
+static ActorTable g_sceneActors;
 
-static std::vector<ActorInfo> g_sceneActors;
+static std::map<int, std::shared_ptr<OStimThreadState>> g_threadStates;
+static std::mutex g_threadStatesMutex;
 
 static bool g_wenchPluginChecked = false;
 static bool g_wenchPluginExists = false;
@@ -627,15 +1580,103 @@ static std::string g_lastProcessedAnimationForTags = "";
 
 static std::chrono::steady_clock::time_point g_sceneStartTime;
 static std::chrono::steady_clock::time_point g_sceneEndTime;
-static std::atomic<bool> g_cleanupPending(false);
+static SceneState g_sceneState = SceneState::Idle;
+static std::optional<SceneInput> g_deferredSceneInput;
+static std::future<SceneWarmup> g_sceneWarmupFuture;
+static bool g_scenePlayerPending = false;
+constexpr size_t kSceneActorReserve = 8;
 
 static bool g_vampireTearsPluginDetected = false;
 
+static ModEventQueue g_modEventQueue;
+static std::thread g_eventWorkerThread;
+static std::atomic<bool> g_eventWorkerActive(false);
+static std::atomic<uint32_t> g_eventQueueSignal(0);
+static std::deque<std::function<void()>> g_sceneStrandTasks;
+static std::mutex g_sceneStrandMutex;
+static thread_local bool t_sceneStrand = false;
+static std::atomic<bool> g_sceneTickPending(false);
+static std::atomic<std::shared_ptr<const SceneSnapshot>> g_sceneSnapshot;
+static uint64_t g_sceneSnapshotVersion = 0;
+static std::atomic<std::shared_ptr<const WorldSnapshot>> g_worldSnapshot;
+static std::atomic<std::shared_ptr<const PluginIndex>> g_pluginIndex;
+static std::atomic<bool> g_worldSnapshotPending(false);
+static std::atomic<uint64_t> g_eventQueueDropped(0);
+static Log2Histogram<> g_eventEnqueueNsHistogram;
+static Log2Histogram<> g_eventQueueDepthHistogram;
+static Log2Histogram<> g_payloadParseNsHistogram;
+
+static std::shared_ptr<const SceneIndexView> g_sceneIndex;
+static std::mutex g_sceneIndexMutex;
+static std::mutex g_sceneIndexBuildMutex;
+static std::thread g_sceneIndexThread;
+static HANDLE g_sceneIndexWatch = INVALID_HANDLE_VALUE;
+static std::atomic<uint32_t> g_sceneIndexGeneration(0);
+
+constexpr size_t kSceneAnalysisCacheSize = 256;
+static std::array<SceneAnalysis, kSceneAnalysisCacheSize> g_sceneAnalysisCache;
+static std::atomic<uint64_t> g_sceneAnalysisHits(0);
+static std::atomic<uint64_t> g_sceneAnalysisMisses(0);
+
+static std::array<std::array<LatencyHistogram, static_cast<size_t>(LatencyInterval::Count)>, kLatencySourceCount>
+    g_latencyHistograms;
+static LatencyHistogram g_logScrapeLagHistogram;
+static thread_local const LatencyTrace* t_latencyTrace = nullptr;
+
+static std::atomic<bool> g_replayActive(false);
+static std::atomic<bool> g_replayComplete(false);
+static bool g_replayWaitLogged = false;
+static std::atomic<bool> g_replayStopRequested(false);
+static std::thread g_replayThread;
+static size_t g_replayCurrentLine = 0;
+static std::vector<std::string> g_replayDecisions;
+static long long g_replaySceneEndLogMs = -1;
+static std::atomic<size_t> g_replayAllocationCount(0);
+static thread_local bool t_replayThread = false;
+static thread_local bool t_countReplayAllocations = false;
+
+#ifdef ORISK_REPLAY_ALLOCATION_COUNTING
+// Bench builds only: counts allocations made while a replay line is processed. The default array
+// and nothrow forms forward here; over-aligned allocations are not counted.
+void* operator new(std::size_t size) {
+    if (t_countReplayAllocations) {
+        g_replayAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        void* ptr = std::malloc(size);
+        if (ptr) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+#endif
+
 void StartMonitoringThread();
 void StopMonitoringThread();
 void WriteToActionsLog(const std::string& message, int lineNumber = 0);
 void WriteToAnimationsLog(const std::string& message, int lineNumber = 0);
 void WriteToOStimEventsLog(const std::string& message, int lineNumber = 0);
+void RecordReplayDecision(const std::string& kind, const std::string& detail);
+void DumpEventQueueStats(const std::string& reason);
+void RecordLatencyInterval(size_t source, LatencyInterval interval, const LatencyTrace& trace, LatencyStage from, LatencyStage to);
+void RecordSpellCastLatency(const LatencyTrace& trace);
+void DumpLatencyStats(const std::string& reason);
 void CheckAndRewardGold();
 void CheckAndRestoreAttributes();
 void CheckAndRewardItem1();
@@ -649,15 +1690,42 @@ void ResolveItemFormIDs();
 void ValidateAndUpdatePluginsInINI();
 bool LoadConfiguration();
 void SaveDefaultConfiguration();
+void SaveDefaultTagRules(const fs::path& rulesPath);
+void SaveDefaultReplayConfiguration(const fs::path& replayPath);
+void ReloadTagRulesIfChanged(const fs::path& rulesPath);
 std::string GetLastAnimation();
 void SetLastAnimation(const std::string& animation);
 bool IsInOStimScene();
 void SetInOStimScene(bool inScene);
+void PostToSceneStrand(std::function<void()> task);
+void EnqueueSceneStrandTask(std::function<void()> task);
+void RunOnSceneStrand(std::function<void()> task);
+void PublishSceneSnapshot();
+std::shared_ptr<const SceneSnapshot> GetSceneSnapshot();
 fs::path GetPluginINIPath();
 RE::FormID GetFormIDFromPlugin(const std::string& pluginName, const std::string& localFormID);
+void BuildPluginIndex();
+std::shared_ptr<const PluginIndex> GetPluginIndex();
+void RequestWorldSnapshot();
+std::shared_ptr<const WorldSnapshot> GetWorldSnapshot();
 bool IsAnyNPCFromPluginNearPlayer(const std::string& pluginName, float maxDistance);
 bool IsSpecificNPCNearPlayer(RE::FormID npcFormID, float maxDistance);
 void DetectNPCNamesFromLine(const std::string& line);
+void ParseModEventPayload(ParsedModEvent& event);
+std::span<const RE::FormID> GetEventActors(const ParsedModEvent& event);
+std::string GetEventSceneID(const ParsedModEvent& event);
+int GetEventSpeed(const ParsedModEvent& event);
+void BenchmarkLogScanner(std::ostream& report);
+void BenchmarkPayloadParser(std::ostream& report);
+void BenchmarkTagKeywordAutomaton(std::ostream& report);
+void BenchmarkActorGrid(std::ostream& report);
+uint64_t HashSceneID(std::string_view sceneID);
+bool LookupSceneMetadata(std::string_view sceneID, SceneIndexEntry& entry);
+TagSet GetAnimationTags(const std::string& animationName);
+SceneAnalysis GetSceneAnalysis(const std::string& animationName);
+void RefreshSceneIndex(const std::string& reason);
+void StartSceneIndexBuild();
+bool AddSceneActorFromEvent(RE::Actor* actor, const std::string& source);
 void FindAndCacheNPCRefIDs();
 void ExecuteConsoleCommand(const std::string& command);
 void CheckExpiredSpellEffects();
@@ -665,12 +1733,27 @@ void DeactivateAllSpellEffects();
 void CleanupSpellEffectsFromLog();
 void CleanupSpellEffectsByFaction();
 void ParseOStimEventFromLine(const std::string& line);
-void ProcessOStimEventData();
 void AnalyzeAnimationForTags(const std::string& animationName);
 void GenerateTagsReport();
-void LogDetectedTags(const std::vector<std::string>& tags, const std::string& eventName);
+void LogDetectedTags(const TagSet& tags, const std::string& eventName);
 ActorInfo CapturePlayerInfo();
 ActorInfo CaptureNPCInfo(const std::string& npcName);
+ActorInfo CaptureActorInfo(RE::Actor* actor);
+int GetEventThreadID(const QueuedModEvent& event);
+void UpdateThreadAnimation(int threadID, const std::string& animationName, const std::string& source);
+void UpdateThreadSpeed(int threadID, int speed);
+void AddThreadActor(int threadID, RE::Actor* actor);
+void RecordThreadOrgasm(int threadID, RE::Actor* actor);
+void EndThreadState(int threadID, const std::string& source);
+void ClearAllThreadStates();
+SceneState ApplySceneInput(const SceneInput& input);
+void ResolveSceneCaches();
+SceneWarmup PrepareSceneWarmup();
+void StartSceneWarmup();
+SceneWarmup TakeSceneWarmup();
+void DiscardSceneWarmup();
+SceneState GetSceneState();
+void ResetSceneStateMachine();
 void LogActorInfo(const ActorInfo& info, bool isPlayer);
 bool IsActorFromPlugin(RE::FormID actorFormID, const std::string& pluginName);
 void GiveAttributesEventReward(int amount, const std::string& actorName, const std::string& gender);
@@ -690,13 +1773,14 @@ void ClearOrgasmCounters();
 bool IsDLCInstalled(const std::string& dlcName);
 bool IsActorVampire(RE::Actor* actor);
 bool IsActorWerewolf(RE::Actor* actor);
-void CheckAnimationTagsForSpellSystems(const std::string& animationName, const std::vector<std::string>& detectedTags);
-void CheckAnimationTagsForSingleActor(const ActorInfo& actorInfo, const std::string& animationName, const std::vector<std::string>& detectedTags);
+void ResolveActorClassForms();
+uint8_t ClassifyActor(RE::Actor* actor);
+void CheckAnimationTagsForSpellSystems(const std::string& animationName);
+void CheckAnimationTagsForSingleActor(const ActorInfo& actorInfo, const std::string& animationName);
 void RemoveTagBasedSpellEffects();
-bool MatchesConfiguredTags(const std::string& animationName, const std::vector<std::string>& detectedTags, const std::string& configuredTagsList);
+bool MatchesConfiguredTags(const std::string& animationName, const TagSet& detectedTags, const std::string& configuredTagsList);
 std::vector<std::string> SplitString(const std::string& str, char delimiter);
 bool MatchesGenderFilter(const std::string& actorGender, const std::string& configuredGenders);
-std::string NormalizeName(const std::string& name);
 void ProcessPendingSpellCasts();
 RE::FormID ResolveStableActorId(RE::FormID observedId, const std::string& observedName);
 bool IsActorReadyForSpell(RE::FormID id);
@@ -717,6 +1801,117 @@ inline bool IsRuntimeFF(RE::FormID id) {
     return ((id >> 24) & 0xFF) == 0xFF;
 }
 
+constexpr size_t kActorIdentityCacheSize = 128;
+
+// Session-lifetime identities of NPCs that took part in scenes, keyed by base FormID and interned
+// name ID, in least-recently-used order. A reused entry is checked against the world snapshot
+// rather than the engine: a ref loaded with the same base is a hit, a ref now on another base is
+// evicted, and one that is not loaded is a miss kept for later scenes.
+class ActorIdentityCache {
+public:
+    void Remember(const ActorInfo& info) {
+        if (!info.captured || info.baseID == 0 || info.refID == 0x14 || IsRuntimeFF(info.refID)) {
+            return;
+        }
+
+        ActorInfo entry = info;
+        if (entry.nameID == kInvalidActorNameID) {
+            entry.nameID = ActorNameTable::Get().Intern(entry.name);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = byBase.find(entry.baseID);
+        if (it != byBase.end()) {
+            EraseName(it->second);
+            it->second->info = entry;
+            lru.splice(lru.begin(), lru, it->second);
+        } else {
+            lru.push_front({entry});
+            byBase[entry.baseID] = lru.begin();
+            if (lru.size() > kActorIdentityCacheSize) {
+                Evict(std::prev(lru.end()));
+            }
+        }
+        byName.insert_or_assign(entry.nameID, lru.begin());
+    }
+
+    std::optional<ActorInfo> FindByNameID(uint32_t nameID) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = byName.find(nameID);
+        if (it == byName.end()) {
+            misses++;
+            return std::nullopt;
+        }
+        return Validate(it->second);
+    }
+
+    void Forget(RE::FormID refID) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = lru.begin(); it != lru.end(); ++it) {
+            if (it->info.refID == refID) {
+                Evict(it);
+                return;
+            }
+        }
+    }
+
+    std::string Summary() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::to_string(lru.size()) + " actors, " + std::to_string(hits) + " hits, " + std::to_string(misses) +
+               " misses, " + std::to_string(stale) + " stale, " + std::to_string(evictions) + " evicted";
+    }
+
+private:
+    struct Entry {
+        ActorInfo info;
+    };
+    using EntryIt = std::list<Entry>::iterator;
+
+    std::optional<ActorInfo> Validate(EntryIt entry) {
+        auto world = GetWorldSnapshot();
+        uint32_t i = world ? world->FindRef(entry->info.refID) : WorldSnapshot::kNotFound;
+        if (i == WorldSnapshot::kNotFound) {
+            misses++;
+            return std::nullopt;
+        }
+        if (world->baseIDs[i] != entry->info.baseID) {
+            stale++;
+            Evict(entry);
+            return std::nullopt;
+        }
+        hits++;
+        entry->info.isVampire = (world->classFlags[i] & kActorClassVampire) != 0;
+        entry->info.isWerewolf = (world->classFlags[i] & kActorClassWerewolf) != 0;
+        lru.splice(lru.begin(), lru, entry);
+        return entry->info;
+    }
+
+    void EraseName(EntryIt entry) {
+        auto it = byName.find(entry->info.nameID);
+        if (it != byName.end() && it->second == entry) {
+            byName.erase(it);
+        }
+    }
+
+    void Evict(EntryIt entry) {
+        EraseName(entry);
+        byBase.erase(entry->info.baseID);
+        lru.erase(entry);
+        evictions++;
+    }
+
+    std::mutex mutex;
+    std::list<Entry> lru;
+    std::unordered_map<RE::FormID, EntryIt> byBase;
+    std::unordered_map<uint32_t, EntryIt> byName;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stale = 0;
+    uint64_t evictions = 0;
+};
+
+static ActorIdentityCache g_actorIdentityCache;
+
 std::string SafeWideStringToString(const std::wstring& wstr) {
     if (wstr.empty()) return std::string();
     try {
@@ -794,54 +1989,103 @@ bool MatchesGenderFilter(const std::string& actorGender, const std::string& conf
     return false;
 }
 
-bool MatchesConfiguredTags(const std::string& animationName, const std::vector<std::string>& detectedTags, const std::string& configuredTagsList) {
+struct ConfiguredTagList {
+    TagSet tags;
+    std::vector<std::string> lowerNames;
+};
+
+const ConfiguredTagList& GetConfiguredTagList(const std::string& configuredTagsList) {
+    static thread_local std::unordered_map<std::string, ConfiguredTagList> cache;
+    
+    auto it = cache.find(configuredTagsList);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    
+    if (cache.size() >= 64) {
+        cache.clear();
+    }
+    
+    ConfiguredTagList parsed;
+    for (const auto& configTag : SplitString(configuredTagsList, ',')) {
+        std::string lowerConfigTag = configTag;
+        std::transform(lowerConfigTag.begin(), lowerConfigTag.end(), lowerConfigTag.begin(), ::tolower);
+        parsed.tags.Add(TagNameTable::Get().InternConfigured(configTag));
+        parsed.lowerNames.push_back(std::move(lowerConfigTag));
+    }
+    return cache.emplace(configuredTagsList, std::move(parsed)).first->second;
+}
+
+bool MatchesConfiguredTags(const std::string& animationName, const TagSet& detectedTags, const std::string& configuredTagsList) {
     if (configuredTagsList.empty()) {
         return false;
     }
     
-    std::vector<std::string> configuredTags = SplitString(configuredTagsList, ',');
+    const ConfiguredTagList& configured = GetConfiguredTagList(configuredTagsList);
     
-    if (configuredTags.empty()) {
+    if (configured.lowerNames.empty()) {
         return false;
     }
     
+    if (detectedTags.Intersects(configured.tags)) {
+        return true;
+    }
+    
     std::string lowerAnimName = animationName;
     std::transform(lowerAnimName.begin(), lowerAnimName.end(), lowerAnimName.begin(), ::tolower);
     
-    for (const auto& configTag : configuredTags) {
-        std::string lowerConfigTag = configTag;
-        std::transform(lowerConfigTag.begin(), lowerConfigTag.end(), lowerConfigTag.begin(), ::tolower);
-        
+    for (const auto& lowerConfigTag : configured.lowerNames) {
         if (lowerAnimName.find(lowerConfigTag) != std::string::npos) {
             return true;
         }
-        
-        for (const auto& detectedTag : detectedTags) {
-            std::string lowerDetectedTag = detectedTag;
-            std::transform(lowerDetectedTag.begin(), lowerDetectedTag.end(), lowerDetectedTag.begin(), ::tolower);
-            
-            if (lowerDetectedTag == lowerConfigTag) {
-                return true;
-            }
-        }
     }
     
     return false;
 }
 
-bool AnimationStillHasConfiguredTags(const std::string& newAnimationName, const std::vector<std::string>& newTags, const std::string& configuredTagsList) {
-    if (configuredTagsList.empty()) {
-        return false;
+SceneAnalysis GetSceneAnalysis(const std::string& animationName) {
+    uint64_t idHash = HashSceneID(animationName);
+    uint32_t configVersion = g_configVersion.load(std::memory_order_acquire);
+    uint32_t indexGeneration = g_sceneIndexGeneration.load(std::memory_order_acquire);
+    
+    SceneAnalysis& slot = g_sceneAnalysisCache[idHash & (kSceneAnalysisCacheSize - 1)];
+    if (slot.valid && slot.idHash == idHash && slot.configVersion == configVersion &&
+        slot.indexGeneration == indexGeneration) {
+        g_sceneAnalysisHits.fetch_add(1, std::memory_order_relaxed);
+        return slot;
     }
+    g_sceneAnalysisMisses.fetch_add(1, std::memory_order_relaxed);
     
-    return MatchesConfiguredTags(newAnimationName, newTags, configuredTagsList);
-}
-
-std::string NormalizeName(const std::string& name) {
-    std::string normalized = name;
-    normalized.erase(0, normalized.find_first_not_of(" \t\r\n"));
-    normalized.erase(normalized.find_last_not_of(" \t\r\n") + 1);
-    return normalized;
+    SceneAnalysis analysis;
+    analysis.idHash = idHash;
+    analysis.configVersion = configVersion;
+    analysis.indexGeneration = indexGeneration;
+    analysis.valid = true;
+    analysis.tags = GetAnimationTags(animationName);
+    
+    analysis.position = GetScenePositionName(analysis.tags);
+    analysis.intensity = GetSceneIntensityName(analysis.tags);
+    
+    auto addMatch = [&](SpellSystemType systemType, bool isPlayer, bool enabled, bool tagsEnabled, const std::string& tagsList) {
+        if (enabled && tagsEnabled && MatchesConfiguredTags(animationName, analysis.tags, tagsList)) {
+            analysis.matchBits |= static_cast<uint8_t>(1u << SceneAnalysis::MatchBit(systemType, isPlayer));
+        }
+    };
+    addMatch(SpellSystemType::EmotionalTears, false, g_config.emotionalTearsNPC.enabled,
+             g_config.emotionalTearsNPC.tagsNameAnimationEnabled, g_config.emotionalTearsNPC.tagsNameAnimationList);
+    addMatch(SpellSystemType::EmotionalTears, true, g_config.emotionalTearsPlayer.enabled,
+             g_config.emotionalTearsPlayer.tagsNameAnimationEnabled, g_config.emotionalTearsPlayer.tagsNameAnimationList);
+    addMatch(SpellSystemType::VampireTears, false, g_config.vampireTearsNPC.enabled,
+             g_config.vampireTearsNPC.tagsNameAnimationEnabled, g_config.vampireTearsNPC.tagsNameAnimationList);
+    addMatch(SpellSystemType::VampireTears, true, g_config.vampireTearsPlayer.enabled,
+             g_config.vampireTearsPlayer.tagsNameAnimationEnabled, g_config.vampireTearsPlayer.tagsNameAnimationList);
+    addMatch(SpellSystemType::BloodyNose, false, g_config.bloodyNoseNPC.enabled,
+             g_config.bloodyNoseNPC.tagsNameAnimationEnabled, g_config.bloodyNoseNPC.tagsNameAnimationList);
+    addMatch(SpellSystemType::BloodyNose, true, g_config.bloodyNosePlayer.enabled,
+             g_config.bloodyNosePlayer.tagsNameAnimationEnabled, g_config.bloodyNosePlayer.tagsNameAnimationList);
+    
+    slot = analysis;
+    return analysis;
 }
 
 std::string GetCurrentTimeString() {
@@ -854,6 +2098,15 @@ std::string GetCurrentTimeString() {
     return ss.str();
 }
 
+long long GetLocalTimeOfDayMs() {
+    auto now = std::chrono::system_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+    std::time_t time_t = std::chrono::system_clock::to_time_t(now);
+    std::tm buf;
+    localtime_s(&buf, &time_t);
+    return ((buf.tm_hour * 60LL + buf.tm_min) * 60LL + buf.tm_sec) * 1000LL + ms.count();
+}
+
 std::string GetCurrentTimeStringWithMillis() {
     auto now = std::chrono::system_clock::now();
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
@@ -867,22 +2120,24 @@ std::string GetCurrentTimeStringWithMillis() {
 }
 
 std::string GetLastAnimation() {
-    std::lock_guard<std::mutex> lock(g_sceneMutex);
-    return g_lastAnimation;
+    if (t_sceneStrand) {
+        return g_lastAnimation;
+    }
+    return GetSceneSnapshot()->lastAnimation;
 }
 
 void SetLastAnimation(const std::string& animation) {
-    std::lock_guard<std::mutex> lock(g_sceneMutex);
     g_lastAnimation = animation;
 }
 
 bool IsInOStimScene() {
-    std::lock_guard<std::mutex> lock(g_sceneMutex);
-    return g_inOStimScene;
+    if (t_sceneStrand) {
+        return g_inOStimScene;
+    }
+    return GetSceneSnapshot()->inScene;
 }
 
 void SetInOStimScene(bool inScene) {
-    std::lock_guard<std::mutex> lock(g_sceneMutex);
     g_inOStimScene = inScene;
     
     if (inScene) {
@@ -1055,6 +2310,17 @@ void WriteToOStimEventsLog(const std::string& message, int lineNumber) {
     }
 }
 
+void RecordReplayDecision(const std::string& kind, const std::string& detail) {
+    if (!t_replayThread) {
+        return;
+    }
+
+    bool wasCounting = t_countReplayAllocations;
+    t_countReplayAllocations = false;
+    g_replayDecisions.push_back(std::to_string(g_replayCurrentLine) + "|" + kind + "|" + detail);
+    t_countReplayAllocations = wasCounting;
+}
+
 void ExecuteConsoleCommand(const std::string& command) {
     auto* task = SKSE::GetTaskInterface();
     if (!task) {
@@ -1122,30 +2388,32 @@ RE::FormID ResolveStableActorId(RE::FormID observedId, const std::string& observ
     if (IsRuntimeFF(observedId)) {
         WriteToActionsLog("ResolveStableActorId: Detected FF runtime ID 0x" + std::to_string(observedId) + " - attempting resolution", __LINE__);
         
-        if (!observedName.empty()) {
+        uint32_t nameID = observedName.empty() ? kInvalidActorNameID : ActorNameTable::Get().Find(observedName);
+        if (nameID != kInvalidActorNameID) {
             std::lock_guard<std::mutex> lock(g_cacheMutex);
             
-            auto it = g_npcNameToRefID.find(observedName);
+            auto it = g_npcNameToRefID.find(nameID);
             if (it != g_npcNameToRefID.end() && !IsRuntimeFF(it->second)) {
                 WriteToActionsLog("ResolveStableActorId: Resolved FF via name '" + observedName + "' to stable ID 0x" + std::to_string(it->second), __LINE__);
                 return it->second;
             }
             
-            std::string normalizedName = NormalizeName(observedName);
-            auto cacheIt = g_nearbyNPCsCache.find(normalizedName);
-            if (cacheIt != g_nearbyNPCsCache.end() && !IsRuntimeFF(cacheIt->second.refID)) {
-                WriteToActionsLog("ResolveStableActorId: Resolved FF via cache '" + normalizedName + "' to stable ID 0x" + std::to_string(cacheIt->second.refID), __LINE__);
-                return cacheIt->second.refID;
+            const ActorInfo* cached = g_nearbyNPCsCache.FindByNameID(nameID);
+            if (cached && !IsRuntimeFF(cached->refID)) {
+                WriteToActionsLog("ResolveStableActorId: Resolved FF via cache '" + cached->name + "' to stable ID 0x" + std::to_string(cached->refID), __LINE__);
+                return cached->refID;
+            }
+            
+            if (auto known = g_actorIdentityCache.FindByNameID(nameID)) {
+                WriteToActionsLog("ResolveStableActorId: Resolved FF via identity cache '" + known->name + "' to stable ID 0x" + std::to_string(known->refID), __LINE__);
+                return known->refID;
             }
         }
         
-        for (const auto& sceneActor : g_sceneActors) {
-            if (!observedName.empty() && 
-                NormalizeName(sceneActor.name) == NormalizeName(observedName) &&
-                !IsRuntimeFF(sceneActor.refID)) {
-                WriteToActionsLog("ResolveStableActorId: Resolved FF via scene actors '" + observedName + "' to stable ID 0x" + std::to_string(sceneActor.refID), __LINE__);
-                return sceneActor.refID;
-            }
+        const ActorInfo* sceneActor = nameID == kInvalidActorNameID ? nullptr : g_sceneActors.FindByNameID(nameID);
+        if (sceneActor && !IsRuntimeFF(sceneActor->refID)) {
+            WriteToActionsLog("ResolveStableActorId: Resolved FF via scene actors '" + observedName + "' to stable ID 0x" + std::to_string(sceneActor->refID), __LINE__);
+            return sceneActor->refID;
         }
         
         WriteToActionsLog("WARNING: ResolveStableActorId: Cannot resolve FF runtime ID 0x" + std::to_string(observedId) + " to stable ID", __LINE__);
@@ -1168,15 +2436,33 @@ fs::path GetPluginINIPath() {
     return pluginConfigDir;
 }
 
-RE::FormID GetFormIDFromPlugin(const std::string& pluginName, const std::string& localFormID) {
+void BuildPluginIndex() {
     auto* dataHandler = RE::TESDataHandler::GetSingleton();
     if (!dataHandler) {
         logger::error("Failed to get TESDataHandler");
-        return 0;
+        return;
     }
+    
+    auto index = PluginIndex::Build(dataHandler);
+    WriteToActionsLog("Plugin index built: " + std::to_string(index->fullCount) + " full, " +
+                          std::to_string(index->lightCount) + " light plugins",
+                      __LINE__);
+    g_pluginIndex.store(std::move(index), std::memory_order_release);
+}
 
-    auto* file = dataHandler->LookupModByName(pluginName);
-    if (!file) {
+std::shared_ptr<const PluginIndex> GetPluginIndex() {
+    return g_pluginIndex.load(std::memory_order_acquire);
+}
+
+RE::FormID GetFormIDFromPlugin(const std::string& pluginName, const std::string& localFormID) {
+    auto plugins = GetPluginIndex();
+    if (!plugins) {
+        logger::error("Plugin index not built");
+        return 0;
+    }
+
+    auto* plugin = plugins->Find(pluginName);
+    if (!plugin) {
         logger::error("Plugin not found: {}", pluginName);
         return 0;
     }
@@ -1194,19 +2480,10 @@ RE::FormID GetFormIDFromPlugin(const std::string& pluginName, const std::string&
         return 0;
     }
 
-    uint8_t modIndex = file->compileIndex;
-    if (modIndex == 0xFF) {
-        modIndex = file->smallFileCompileIndex;
-    }
-
-    RE::FormID fullFormID = (static_cast<RE::FormID>(modIndex) << 24) | (localID & 0x00FFFFFF);
-    
-    return fullFormID;
+    return plugin->Compose(localID);
 }
 
 bool ShouldProcessOrgasmEvent(RE::FormID actorFormID) {
-    std::lock_guard<std::mutex> lock(g_orgasmMutex);
-    
     auto now = std::chrono::steady_clock::now();
     
     auto it = g_lastOrgasmTimestamps.find(actorFormID);
@@ -1222,13 +2499,10 @@ bool ShouldProcessOrgasmEvent(RE::FormID actorFormID) {
 }
 
 void UpdateOrgasmTimestamp(RE::FormID actorFormID) {
-    std::lock_guard<std::mutex> lock(g_orgasmMutex);
     g_lastOrgasmTimestamps[actorFormID] = std::chrono::steady_clock::now();
 }
 
 void IncrementOrgasmCounter(RE::FormID actorFormID, const std::string& actorName, bool isPlayer, const std::string& gender) {
-    std::lock_guard<std::mutex> lock(g_orgasmCounterMutex);
-    
     for (auto& counter : g_actorOrgasmCounters) {
         if (counter.actorFormID == actorFormID) {
             counter.orgasmCount++;
@@ -1250,14 +2524,11 @@ void IncrementOrgasmCounter(RE::FormID actorFormID, const std::string& actorName
 }
 
 void ClearOrgasmCounters() {
-    std::lock_guard<std::mutex> lock(g_orgasmCounterMutex);
     g_actorOrgasmCounters.clear();
     WriteToOStimEventsLog("Orgasm counters cleared", __LINE__);
 }
 
 void IncrementBloodyNoseCounter(RE::FormID actorFormID, const std::string& actorName, bool isPlayer, const std::string& gender) {
-    std::lock_guard<std::mutex> lock(g_bloodyNoseCounterMutex);
-
     for (auto& counter : g_bloodyNoseCounters) {
         if (counter.actorFormID == actorFormID) {
             counter.orgasmCount++;
@@ -1280,15 +2551,12 @@ void IncrementBloodyNoseCounter(RE::FormID actorFormID, const std::string& actor
 }
 
 void ClearBloodyNoseCounters() {
-    std::lock_guard<std::mutex> lock(g_bloodyNoseCounterMutex);
     g_bloodyNoseCounters.clear();
     WriteToOStimEventsLog("BloodyNose counters cleared", __LINE__);
 }
 
 // ===== FIXED BLOODY NOSE COUNTER SYSTEM WITH PROPER SPELL DEACTIVATION =====
 void CheckBloodyNoseCounters() {
-    std::lock_guard<std::mutex> lock(g_bloodyNoseCounterMutex);
-    
     auto now = std::chrono::steady_clock::now();
     
     for (auto& counter : g_bloodyNoseCounters) {
@@ -1331,11 +2599,8 @@ void CheckBloodyNoseCounters() {
 }
 
 bool IsDLCInstalled(const std::string& dlcName) {
-    auto* dataHandler = RE::TESDataHandler::GetSingleton();
-    if (!dataHandler) return false;
-    
-    auto* file = dataHandler->LookupModByName(dlcName);
-    return (file != nullptr);
+    auto plugins = GetPluginIndex();
+    return plugins && plugins->Find(dlcName) != nullptr;
 }
 
 bool IsActorVampire(RE::Actor* actor) {
@@ -1352,12 +2617,8 @@ bool IsActorVampire(RE::Actor* actor) {
         }
     }
     
-    auto* dataHandler = RE::TESDataHandler::GetSingleton();
-    if (dataHandler && IsDLCInstalled("Dawnguard.esm")) {
-        auto* vampireFaction = dataHandler->LookupForm<RE::TESFaction>(0x020142E6, "Dawnguard.esm");
-        if (vampireFaction && actor->IsInFaction(vampireFaction)) {
-            return true;
-        }
+    if (g_actorClassForms.vampireFaction && actor->IsInFaction(g_actorClassForms.vampireFaction)) {
+        return true;
     }
     
     return false;
@@ -1377,262 +2638,250 @@ bool IsActorWerewolf(RE::Actor* actor) {
         }
     }
     
-    auto* dataHandler = RE::TESDataHandler::GetSingleton();
-    if (dataHandler) {
-        auto* werewolfFaction = dataHandler->LookupForm<RE::TESFaction>(0x0009A741, "Skyrim.esm");
-        if (werewolfFaction && actor->IsInFaction(werewolfFaction)) {
-            return true;
-        }
+    if (g_actorClassForms.werewolfFaction && actor->IsInFaction(g_actorClassForms.werewolfFaction)) {
+        return true;
     }
     
     return false;
 }
 
-bool IsAnyNPCFromPluginNearPlayer(const std::string& pluginName, float maxDistance) {
-    auto* player = RE::PlayerCharacter::GetSingleton();
-    if (!player) {
-        return false;
-    }
-    
+void ResolveActorClassForms() {
     auto* dataHandler = RE::TESDataHandler::GetSingleton();
     if (!dataHandler) {
-        return false;
+        return;
     }
     
-    auto* file = dataHandler->LookupModByName(pluginName);
-    if (!file) {
-        return false;
+    if (IsDLCInstalled("Dawnguard.esm")) {
+        g_actorClassForms.vampireFaction = dataHandler->LookupForm<RE::TESFaction>(0x020142E6, "Dawnguard.esm");
     }
+    g_actorClassForms.werewolfFaction = dataHandler->LookupForm<RE::TESFaction>(0x0009A741, "Skyrim.esm");
+    g_actorClassForms.resolved = true;
     
-    uint8_t modIndex = file->compileIndex;
-    if (modIndex == 0xFF) {
-        modIndex = file->smallFileCompileIndex;
+    WriteToActionsLog(std::string("Actor class factions resolved - Vampire: ") +
+                          (g_actorClassForms.vampireFaction ? "OK" : "not found") +
+                          ", Werewolf: " + (g_actorClassForms.werewolfFaction ? "OK" : "not found"),
+                      __LINE__);
+}
+
+uint8_t ClassifyActor(RE::Actor* actor) {
+    if (!actor) {
+        return 0;
+    }
+    
+    uint8_t flags = 0;
+    RE::FormID refID = actor->GetFormID();
+    bool cacheable = !IsRuntimeFF(refID);
+    if (cacheable && g_actorClassCache.Find(refID, flags)) {
+        return flags;
+    }
+    
+    flags = (IsActorVampire(actor) ? kActorClassVampire : 0) | (IsActorWerewolf(actor) ? kActorClassWerewolf : 0);
+    if (cacheable && g_actorClassForms.resolved) {
+        g_actorClassCache.Store(refID, flags);
     }
+    return flags;
+}
+
+void CaptureWorldSnapshot() {
+    // Game thread only. Runtime 0xFF bases are recycled, so only persistent bases are cached.
+    static std::unordered_map<RE::FormID, uint32_t> baseNameIDs;
     
+    auto* player = RE::PlayerCharacter::GetSingleton();
     auto* processLists = RE::ProcessLists::GetSingleton();
-    if (!processLists) {
-        return false;
+    if (!player || !processLists) {
+        g_worldSnapshotPending = false;
+        return;
     }
     
-    RE::NiPoint3 playerPos = player->GetPosition();
+    auto snapshot = std::make_shared<WorldSnapshot>();
+    snapshot->tick = g_monitorCycles.load();
+    snapshot->playerPos = player->GetPosition();
+    snapshot->player = CaptureActorInfo(player);
     
-    for (auto& actorHandle : processLists->highActorHandles) {
-        auto actor = actorHandle.get();
-        if (!actor) continue;
-        
-        auto* actorBase = actor->GetActorBase();
-        if (!actorBase) continue;
-        
-        uint8_t npcModIndex = (actorBase->formID >> 24) & 0xFF;
-        if (npcModIndex == modIndex) {
-            RE::NiPoint3 npcPos = actor->GetPosition();
-            float distance = playerPos.GetDistance(npcPos);
+    size_t capacity = processLists->highActorHandles.size() + processLists->middleHighActorHandles.size() +
+                      processLists->lowActorHandles.size();
+    snapshot->refIDs.reserve(capacity);
+    snapshot->baseIDs.reserve(capacity);
+    snapshot->positions.reserve(capacity);
+    snapshot->female.reserve(capacity);
+    snapshot->nameIDs.reserve(capacity);
+    snapshot->names.reserve(capacity);
+    snapshot->raceNames.reserve(capacity);
+    snapshot->classFlags.reserve(capacity);
+    
+    auto captureList = [&](auto& actorHandles) {
+        for (auto& actorHandle : actorHandles) {
+            auto actor = actorHandle.get();
+            if (!actor) continue;
             
-            if (distance <= maxDistance) {
-                return true;
+            auto* actorBase = actor->GetActorBase();
+            if (!actorBase) continue;
+            
+            const char* name = actorBase->GetName();
+            uint32_t nameID;
+            if (IsRuntimeFF(actorBase->formID)) {
+                nameID = ActorNameTable::Get().Intern(name);
+            } else {
+                auto nameIt = baseNameIDs.find(actorBase->formID);
+                if (nameIt == baseNameIDs.end()) {
+                    nameIt = baseNameIDs.emplace(actorBase->formID, ActorNameTable::Get().Intern(name)).first;
+                }
+                nameID = nameIt->second;
             }
+            
+            snapshot->refIDs.push_back(actor->GetFormID());
+            snapshot->baseIDs.push_back(actorBase->formID);
+            snapshot->positions.push_back(actor->GetPosition());
+            snapshot->female.push_back(actorBase->IsFemale() ? 1 : 0);
+            snapshot->nameIDs.push_back(nameID);
+            snapshot->names.emplace_back(name);
+            auto* race = actorBase->GetRace();
+            snapshot->raceNames.emplace_back(race ? race->GetName() : "Unknown");
+            snapshot->classFlags.push_back(ClassifyActor(actor.get()));
         }
+    };
+    
+    captureList(processLists->highActorHandles);
+    captureList(processLists->middleHighActorHandles);
+    captureList(processLists->lowActorHandles);
+    snapshot->grid.Build(snapshot->positions);
+    
+    g_worldSnapshot.store(std::move(snapshot), std::memory_order_release);
+    g_worldSnapshotPending = false;
+}
+
+void RequestWorldSnapshot() {
+    if (g_worldSnapshotPending.exchange(true)) {
+        return;
     }
     
-    return false;
+    auto* task = SKSE::GetTaskInterface();
+    if (!task) {
+        g_worldSnapshotPending = false;
+        return;
+    }
+    
+    task->AddTask([]() {
+        try {
+            CaptureWorldSnapshot();
+        } catch (...) {
+            g_worldSnapshotPending = false;
+        }
+    });
 }
 
-bool IsSpecificNPCNearPlayer(RE::FormID npcFormID, float maxDistance) {
-    auto* player = RE::PlayerCharacter::GetSingleton();
-    if (!player) {
+// Returns nullptr outside scenes and when the last capture is too old to trust.
+std::shared_ptr<const WorldSnapshot> GetWorldSnapshot() {
+    auto snapshot = g_worldSnapshot.load(std::memory_order_acquire);
+    uint64_t currentTick = g_monitorCycles.load();
+    if (!snapshot || snapshot->tick > currentTick || currentTick - snapshot->tick > kWorldSnapshotMaxAgeTicks) {
+        return nullptr;
+    }
+    return snapshot;
+}
+
+bool IsAnyNPCFromPluginNearPlayer(const std::string& pluginName, float maxDistance) {
+    auto plugins = GetPluginIndex();
+    auto* plugin = plugins ? plugins->Find(pluginName) : nullptr;
+    if (!plugin) {
         return false;
     }
     
-    auto* processLists = RE::ProcessLists::GetSingleton();
-    if (!processLists) {
+    auto world = GetWorldSnapshot();
+    if (!world) {
         return false;
     }
     
-    RE::NiPoint3 playerPos = player->GetPosition();
-    
-    for (auto& actorHandle : processLists->highActorHandles) {
-        auto actor = actorHandle.get();
-        if (!actor) continue;
-        
-        auto* actorBase = actor->GetActorBase();
-        if (!actorBase) continue;
-        
-        if (actorBase->formID == npcFormID) {
-            RE::NiPoint3 npcPos = actor->GetPosition();
-            float distance = playerPos.GetDistance(npcPos);
-            
-            if (distance <= maxDistance) {
-                return true;
-            }
-        }
+    return world->ForEachNearPlayer(maxDistance, ActorFilter::FromPlugin(*plugin), [](uint32_t) { return true; });
+}
+
+bool IsSpecificNPCNearPlayer(RE::FormID npcFormID, float maxDistance) {
+    auto world = GetWorldSnapshot();
+    if (!world) {
+        return false;
     }
     
-    return false;
+    return world->ForEachNearPlayer(maxDistance, ActorFilter::ForBase(npcFormID), [](uint32_t) { return true; });
 }
 
 void BuildNPCsCacheForScene() {
-    std::lock_guard<std::mutex> lock(g_cacheMutex);
-    
-    g_nearbyNPCsCache.clear();
-    
-    auto* player = RE::PlayerCharacter::GetSingleton();
-    if (!player) return;
-    
-    auto* processLists = RE::ProcessLists::GetSingleton();
-    if (!processLists) return;
+    if (t_replayThread) {
+        return;
+    }
     
-    RE::NiPoint3 playerPos = player->GetPosition();
-    float maxDistance = 3000.0f;
+    auto world = GetWorldSnapshot();
+    if (!world) {
+        WriteToAnimationsLog("NPC cache not built: no current world snapshot", __LINE__);
+        return;
+    }
     
-    auto processActorList = [&](auto& actorHandles) {
-        for (auto& actorHandle : actorHandles) {
-            auto actor = actorHandle.get();
-            if (!actor) continue;
-            
-            auto* actorBase = actor->GetActorBase();
-            if (!actorBase) continue;
-            
-            RE::NiPoint3 npcPos = actor->GetPosition();
-            float distance = playerPos.GetDistance(npcPos);
-            
-            if (distance <= maxDistance) {
-                ActorInfo info;
-                info.name = actorBase->GetName();
-                info.refID = actor->GetFormID();
-                info.baseID = actorBase->GetFormID();
-                
-                auto* race = actorBase->GetRace();
-                if (race) {
-                    info.race = race->GetName();
-                } else {
-                    info.race = "Unknown";
-                }
-                
-                info.gender = actorBase->IsFemale() ? "Female" : "Male";
-                
-                info.isVampire = IsActorVampire(actor.get());
-                info.isWerewolf = IsActorWerewolf(actor.get());
-                
-                info.captured = true;
-                
-                std::string normalizedName = NormalizeName(info.name);
-                
-                g_nearbyNPCsCache[normalizedName] = info;
-            }
-        }
-    };
+    std::lock_guard<std::mutex> lock(g_cacheMutex);
     
-    processActorList(processLists->highActorHandles);
-    processActorList(processLists->middleHighActorHandles);
-    processActorList(processLists->lowActorHandles);
+    g_nearbyNPCsCache.clear();
+    world->ForEachNearPlayer(kSceneNPCCacheRadius, {}, [&](uint32_t i) {
+        g_nearbyNPCsCache.Insert(world->ActorInfoAt(i), world->playerPos.GetDistance(world->positions[i]));
+        return false;
+    });
     
+    g_nearbyNPCsCacheBuilt = true;
     WriteToAnimationsLog("NPC cache built: " + std::to_string(g_nearbyNPCsCache.size()) + " NPCs within 3000 units", __LINE__);
 }
 
 void ClearNPCsCache() {
     std::lock_guard<std::mutex> lock(g_cacheMutex);
     g_nearbyNPCsCache.clear();
+    g_nearbyNPCsCacheBuilt = false;
     WriteToAnimationsLog("NPC cache cleared", __LINE__);
 }
 
+// Reads the player from the world snapshot, so it is safe off the game thread. Not captured until
+// a snapshot exists.
 ActorInfo CapturePlayerInfo() {
     ActorInfo info;
-    
-    auto* player = RE::PlayerCharacter::GetSingleton();
-    if (!player) {
+    if (t_replayThread) {
         return info;
     }
     
-    auto* playerBase = player->GetActorBase();
-    if (!playerBase) {
+    auto world = GetWorldSnapshot();
+    return world ? world->player : info;
+}
+
+ActorInfo CaptureNPCInfo(const std::string& npcName) {
+    ActorInfo info;
+    info.name = npcName;
+    info.nameID = ActorNameTable::Get().Intern(npcName);
+
+    auto world = GetWorldSnapshot();
+    if (!world) {
         return info;
     }
     
-    info.name = playerBase->GetName();
-    info.refID = player->GetFormID();
-    info.baseID = playerBase->GetFormID();
-    
-    auto* race = playerBase->GetRace();
-    if (race) {
-        info.race = race->GetName();
-    } else {
-        info.race = "Unknown";
-    }
-    
-    info.gender = playerBase->IsFemale() ? "Female" : "Male";
-    
-    info.isVampire = IsActorVampire(player);
-    info.isWerewolf = IsActorWerewolf(player);
-    
-    info.captured = true;
+    world->ForEachNearPlayer(kSceneNPCCacheRadius, {}, [&](uint32_t i) {
+        if (world->nameIDs[i] != info.nameID) {
+            return false;
+        }
+        info = world->ActorInfoAt(i);
+        return true;
+    });
     
     return info;
 }
 
-ActorInfo CaptureNPCInfo(const std::string& npcName) {
+ActorInfo CaptureActorInfo(RE::Actor* actor) {
     ActorInfo info;
-    info.name = npcName;
-    
-    auto* player = RE::PlayerCharacter::GetSingleton();
-    if (!player) {
+    if (!actor) {
         return info;
     }
     
-    auto* processLists = RE::ProcessLists::GetSingleton();
-    if (!processLists) {
+    auto* actorBase = actor->GetActorBase();
+    if (!actorBase) {
         return info;
     }
     
-    RE::NiPoint3 playerPos = player->GetPosition();
-    float maxDistance = 3000.0f;
-    
-    std::string normalizedSearchName = NormalizeName(npcName);
-    
-    auto searchInList = [&](auto& actorHandles) -> bool {
-        for (auto& actorHandle : actorHandles) {
-            auto actor = actorHandle.get();
-            if (!actor) continue;
-            
-            auto* actorBase = actor->GetActorBase();
-            if (!actorBase) continue;
-            
-            std::string actorName = actorBase->GetName();
-            std::string normalizedActorName = NormalizeName(actorName);
-            
-            if (normalizedActorName == normalizedSearchName) {
-                RE::NiPoint3 npcPos = actor->GetPosition();
-                float distance = playerPos.GetDistance(npcPos);
-                
-                if (distance <= maxDistance) {
-                    info.refID = actor->GetFormID();
-                    info.baseID = actorBase->GetFormID();
-                    
-                    auto* race = actorBase->GetRace();
-                    if (race) {
-                        info.race = race->GetName();
-                    } else {
-                        info.race = "Unknown";
-                    }
-                    
-                    info.gender = actorBase->IsFemale() ? "Female" : "Male";
-                    
-                    info.isVampire = IsActorVampire(actor.get());
-                    info.isWerewolf = IsActorWerewolf(actor.get());
-                    
-                    info.captured = true;
-                    
-                    return true;
-                }
-            }
-        }
-        return false;
-    };
-    
-    if (searchInList(processLists->highActorHandles)) return info;
-    if (searchInList(processLists->middleHighActorHandles)) return info;
-    if (searchInList(processLists->lowActorHandles)) return info;
-    
-    return info;
+    const char* name = actorBase->GetName();
+    auto* race = actorBase->GetRace();
+    return ActorInfo::FromForms(name, ActorNameTable::Get().Intern(name), actor->GetFormID(), actorBase->GetFormID(),
+                                race ? race->GetName() : "Unknown", actorBase->IsFemale(), ClassifyActor(actor));
 }
 
 void LogActorInfo(const ActorInfo& info, bool isPlayer) {
@@ -1665,149 +2914,182 @@ void LogActorInfo(const ActorInfo& info, bool isPlayer) {
 void AnalyzeAnimationForTags(const std::string& animationName) {
     if (animationName.empty()) return;
     
+    SceneAnalysis analysis = GetSceneAnalysis(animationName);
+    
     g_currentAnimationInfo.animationName = animationName;
-    g_currentAnimationInfo.implicitTags = TagAnalyzer::ExtractTagsFromAnimationName(animationName);
+    g_currentAnimationInfo.implicitTags = analysis.tags;
+    g_currentAnimationInfo.position = analysis.position;
+    g_currentAnimationInfo.intensity = analysis.intensity;
     g_currentAnimationInfo.detectedTime = std::chrono::steady_clock::now();
     
-    std::string position = "Unknown";
-    for (const auto& tag : g_currentAnimationInfo.implicitTags) {
-        if (tag == "Standing" || tag == "Sitting" || tag == "Lying" || tag == "Doggy" || tag == "Missionary") {
-            position = tag;
-            break;
-        }
-    }
-    g_currentAnimationInfo.position = position;
-    
-    std::string intensity = "Normal";
-    for (const auto& tag : g_currentAnimationInfo.implicitTags) {
-        if (tag == "Rough" || tag == "Aggressive") {
-            intensity = "High";
-            break;
-        } else if (tag == "Gentle") {
-            intensity = "Low";
-            break;
-        }
+    const TagSet& tags = g_currentAnimationInfo.implicitTags;
+    const std::string& position = g_currentAnimationInfo.position;
+    const std::string& intensity = g_currentAnimationInfo.intensity;
+
+    if (t_replayThread) {
+        RecordReplayDecision("TAGS", animationName + "|" + position + "|" + intensity + "|" + FormatTagSet(tags, ","));
     }
-    g_currentAnimationInfo.intensity = intensity;
     
-    if (!g_currentAnimationInfo.implicitTags.empty()) {
+    if (!tags.Empty()) {
         WriteToOStimEventsLog("========================================", __LINE__);
         WriteToOStimEventsLog("ANIMATION TAGS ANALYSIS", __LINE__);
         WriteToOStimEventsLog("Animation: " + animationName, __LINE__);
         WriteToOStimEventsLog("Position: " + position, __LINE__);
         WriteToOStimEventsLog("Intensity: " + intensity, __LINE__);
         
-        std::string tagsStr = "Detected Tags: ";
-        for (size_t i = 0; i < g_currentAnimationInfo.implicitTags.size(); i++) {
-            tagsStr += g_currentAnimationInfo.implicitTags[i];
-            if (i < g_currentAnimationInfo.implicitTags.size() - 1) {
-                tagsStr += ", ";
-            }
-        }
-        WriteToOStimEventsLog(tagsStr, __LINE__);
+        WriteToOStimEventsLog("Detected Tags: " + FormatTagSet(tags), __LINE__);
         WriteToOStimEventsLog("========================================", __LINE__);
     }
 }
 
-void LogDetectedTags(const std::vector<std::string>& tags, const std::string& eventName) {
-    if (tags.empty()) return;
+void LogDetectedTags(const TagSet& tags, const std::string& eventName) {
+    if (tags.Empty()) return;
     
     WriteToOStimEventsLog("========================================", __LINE__);
     WriteToOStimEventsLog("TAGS DETECTED FROM EVENT", __LINE__);
     WriteToOStimEventsLog("Event: " + eventName, __LINE__);
     
-    std::string tagsStr = "Tags: ";
-    for (size_t i = 0; i < tags.size(); i++) {
-        tagsStr += tags[i];
-        if (i < tags.size() - 1) {
-            tagsStr += ", ";
-        }
-    }
-    WriteToOStimEventsLog(tagsStr, __LINE__);
+    WriteToOStimEventsLog("Tags: " + FormatTagSet(tags), __LINE__);
     WriteToOStimEventsLog("========================================", __LINE__);
 }
 
 void GenerateTagsReport() {
-    if (!IsInOStimScene() || g_currentAnimationInfo.animationName.empty()) {
+    const SceneTagStats& stats = g_sceneTagStats;
+    if (stats.seenTags.Empty() && stats.speedChanges == 0) {
         return;
     }
     
     auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - g_lastOStimEventCheck).count();
-    
-    if (elapsed < 10) return;
+    auto seconds = [](std::chrono::steady_clock::duration d) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.1fs", std::chrono::duration<double>(d).count());
+        return std::string(buffer);
+    };
     
-    g_lastOStimEventCheck = now;
+    std::string tagTimes;
+    stats.seenTags.ForEach([&](uint32_t id) {
+        if (!tagTimes.empty()) {
+            tagTimes += ", ";
+        }
+        tagTimes += std::string(TagNameTable::Get().Name(id)) + "=" + seconds(stats.TagTime(id, now));
+    });
     
-    if (!g_currentOStimTags.empty() || g_currentOStimSpeed > 0) {
-        WriteToOStimEventsLog("========================================", __LINE__);
-        WriteToOStimEventsLog("PERIODIC TAGS REPORT", __LINE__);
-        WriteToOStimEventsLog("Current Animation: " + g_currentAnimationInfo.animationName, __LINE__);
-        WriteToOStimEventsLog("Position: " + g_currentAnimationInfo.position, __LINE__);
-        WriteToOStimEventsLog("Intensity: " + g_currentAnimationInfo.intensity, __LINE__);
-        WriteToOStimEventsLog("Speed Level: " + std::to_string(g_currentOStimSpeed), __LINE__);
-        
-        if (!g_currentAnimationInfo.implicitTags.empty()) {
-            std::string tagsStr = "Active Tags: ";
-            for (size_t i = 0; i < g_currentAnimationInfo.implicitTags.size(); i++) {
-                tagsStr += g_currentAnimationInfo.implicitTags[i];
-                if (i < g_currentAnimationInfo.implicitTags.size() - 1) {
-                    tagsStr += ", ";
-                }
+    std::string speedTimes;
+    for (size_t slot = 0; slot < SceneTagStats::kSpeedLevels; slot++) {
+        auto time = stats.SpeedTime(slot, now);
+        if (time > std::chrono::steady_clock::duration::zero()) {
+            if (!speedTimes.empty()) {
+                speedTimes += ", ";
             }
-            WriteToOStimEventsLog(tagsStr, __LINE__);
-        } else {
-            WriteToOStimEventsLog("Active Tags: None", __LINE__);
+            speedTimes += std::to_string(slot) + "=" + seconds(time);
         }
-        
-        WriteToOStimEventsLog("========================================", __LINE__);
     }
+    
+    WriteToOStimEventsLog("========================================", __LINE__);
+    WriteToOStimEventsLog("TAGS REPORT", __LINE__);
+    WriteToOStimEventsLog("Current Animation: " + g_currentAnimationInfo.animationName + " | Position: " +
+                              g_currentAnimationInfo.position + " | Intensity: " + g_currentAnimationInfo.intensity,
+                          __LINE__);
+    WriteToOStimEventsLog("Speed Level: " + std::to_string(stats.speed) + " (" + std::to_string(stats.speedChanges) + " changes)",
+                          __LINE__);
+    WriteToOStimEventsLog("Active Tags: " + (stats.tags.Empty() ? std::string("None") : FormatTagSet(stats.tags)), __LINE__);
+    WriteToOStimEventsLog("Time in tag: " + (tagTimes.empty() ? std::string("None") : tagTimes), __LINE__);
+    WriteToOStimEventsLog("Time at speed: " + (speedTimes.empty() ? std::string("None") : speedTimes), __LINE__);
+    WriteToOStimEventsLog("========================================", __LINE__);
 }
 
-void DetectNPCNamesFromLine(const std::string& line) {
-    bool hasVoiceSetFound = (line.find("voice set") != std::string::npos && 
-                             line.find("found for actor") != std::string::npos);
-    bool hasNoVoiceSet = (line.find("no voice set found for actor") != std::string::npos);
-    
-    if (!hasVoiceSetFound && !hasNoVoiceSet) {
+void ParseModEventPayload(ParsedModEvent& event) {
+    event.payload = OStimEventPayload{};
+    event.hasPayload = false;
+    const char* raw = event.strArg.c_str();
+    if (raw == nullptr || !OStimJsonReader::LooksLikeJson(raw)) {
         return;
     }
+    auto parseStart = std::chrono::steady_clock::now();
+    event.hasPayload = OStimJsonReader::Parse(raw, event.payload);
+    g_payloadParseNsHistogram.Record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - parseStart).count()));
+}
 
-    size_t actorPos = line.find("found for actor ");
-    if (actorPos == std::string::npos) {
-        return;
+std::span<const RE::FormID> GetEventActors(const ParsedModEvent& event) {
+    if (!event.hasPayload) {
+        return {};
     }
+    return std::span<const RE::FormID>(event.payload.actors.data(), event.payload.actorCount);
+}
 
-    size_t nameStart = actorPos + 16;
-    
-    size_t nameEndBy = line.find(" by", nameStart);
-    size_t nameEndComma = line.find(", using", nameStart);
-    
-    size_t nameEnd = std::string::npos;
-    if (nameEndBy != std::string::npos && nameEndComma != std::string::npos) {
-        nameEnd = std::min(nameEndBy, nameEndComma);
-    } else if (nameEndBy != std::string::npos) {
-        nameEnd = nameEndBy;
-    } else if (nameEndComma != std::string::npos) {
-        nameEnd = nameEndComma;
+std::string GetEventSceneID(const ParsedModEvent& event) {
+    const char* raw = event.strArg.c_str();
+    if (raw == nullptr || raw[0] == '\0') {
+        return "";
     }
-    
-    if (nameEnd == std::string::npos || nameEnd <= nameStart) {
-        return;
+    if (event.hasPayload) {
+        return std::string(event.payload.sceneID);
     }
+    return raw;
+}
 
-    std::string npcName = line.substr(nameStart, nameEnd - nameStart);
-    
-    npcName.erase(0, npcName.find_first_not_of(" \t\r\n"));
-    npcName.erase(npcName.find_last_not_of(" \t\r\n") + 1);
-    
-    if (npcName.empty() || npcName == ",") {
+int GetEventSpeed(const ParsedModEvent& event) {
+    const char* raw = event.strArg.c_str();
+    if (raw == nullptr || raw[0] == '\0') {
+        return -1;
+    }
+    if (event.hasPayload) {
+        return event.payload.speed;
+    }
+    int speed = -1;
+    std::from_chars(raw, raw + strlen(raw), speed);
+    return speed;
+}
+
+bool AddSceneActorFromEvent(RE::Actor* actor, const std::string& source) {
+    if (!actor || actor->GetFormID() == 0x14) {
+        return false;
+    }
+
+    RE::FormID refID = actor->GetFormID();
+    if (g_sceneActors.Find(refID)) {
+        return false;
+    }
+
+    ActorInfo info = CaptureActorInfo(actor);
+    if (!info.captured) {
+        return false;
+    }
+
+    g_sceneActors.Insert(info);
+    g_actorIdentityCache.Remember(info);
+
+    if (std::none_of(g_detectedNPCNames.begin(), g_detectedNPCNames.end(),
+                     [&](const DetectedNPCName& detected) { return detected.nameID == info.nameID; })) {
+        g_detectedNPCNames.push_back({info.name, info.nameID});
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_cacheMutex);
+        g_npcNameToRefID[info.nameID] = refID;
+    }
+
+    RecordReplayDecision("ACTOR", info.name + "|event");
+    WriteToAnimationsLog("Scene actor from " + source + ": " + info.name, __LINE__);
+    LogActorInfo(info, false);
+
+    if (!g_currentAnimationInfo.animationName.empty()) {
+        CheckAnimationTagsForSingleActor(info, g_currentAnimationInfo.animationName);
+    }
+
+    return true;
+}
+
+void DetectNPCNamesFromLine(const std::string& line) {
+    std::string npcName(ExtractVoiceSetActorName(line));
+    if (npcName.empty()) {
         return;
     }
     
+    uint32_t nameID = ActorNameTable::Get().Intern(npcName);
     bool alreadyDetected = false;
-    for (const auto& detectedName : g_detectedNPCNames) {
-        if (detectedName == npcName) {
+    for (const auto& detected : g_detectedNPCNames) {
+        if (detected.nameID == nameID) {
             alreadyDetected = true;
             break;
         }
@@ -1818,44 +3100,52 @@ void DetectNPCNamesFromLine(const std::string& line) {
         if (player) {
             auto* playerBase = player->GetActorBase();
             if (playerBase) {
-                std::string playerName = playerBase->GetName();
-                std::string normalizedPlayerName = NormalizeName(playerName);
-                std::string normalizedNPCName = NormalizeName(npcName);
-                
-                if (normalizedPlayerName == normalizedNPCName) {
+                if (ActorNameTable::Get().Intern(playerBase->GetName()) == nameID) {
                     WriteToAnimationsLog("Detected player name in OStim log, skipping: " + npcName, __LINE__);
                     return;
                 }
             }
         }
         
-        g_detectedNPCNames.push_back(npcName);
+        g_detectedNPCNames.push_back({npcName, nameID});
         
-        std::string normalizedNPCName = NormalizeName(npcName);
+        std::optional<ActorInfo> known =
+            t_replayThread ? std::nullopt : g_actorIdentityCache.FindByNameID(nameID);
+        if (!known && !g_nearbyNPCsCacheBuilt) {
+            BuildNPCsCacheForScene();
+        }
         
         std::lock_guard<std::mutex> lock(g_cacheMutex);
-        auto it = g_nearbyNPCsCache.find(normalizedNPCName);
+        float distance = std::numeric_limits<float>::max();
+        const ActorInfo* cached = known ? &*known : g_nearbyNPCsCache.FindByNameID(nameID, &distance);
+        if (known) {
+            g_npcNameToRefID[nameID] = known->refID;
+        }
+
+        RecordReplayDecision("ACTOR", npcName + "|" + (cached ? "cached" : "not_cached"));
         
-        if (it != g_nearbyNPCsCache.end()) {
-            ActorInfo npcInfo = it->second;
-            g_sceneActors.push_back(npcInfo);
+        if (cached) {
+            ActorInfo npcInfo = *cached;
+            if (!g_sceneActors.Insert(npcInfo, distance)) {
+                return;
+            }
             LogActorInfo(npcInfo, false);
             
             if (!g_currentAnimationInfo.animationName.empty()) {
-                CheckAnimationTagsForSingleActor(npcInfo, g_currentAnimationInfo.animationName, g_currentAnimationInfo.implicitTags);
+                CheckAnimationTagsForSingleActor(npcInfo, g_currentAnimationInfo.animationName);
             }
         } else {
             WriteToAnimationsLog("========================================", __LINE__);
             WriteToAnimationsLog("NPC NOT FOUND IN CACHE", __LINE__);
             WriteToAnimationsLog("Name from OStim log: " + npcName, __LINE__);
-            WriteToAnimationsLog("Normalized name: " + normalizedNPCName, __LINE__);
+            WriteToAnimationsLog("Normalized name: " + ActorNameTable::Get().Name(nameID), __LINE__);
             WriteToAnimationsLog("Cache size: " + std::to_string(g_nearbyNPCsCache.size()) + " NPCs", __LINE__);
             
             std::string cachedNames = "Cached NPCs: ";
             int count = 0;
-            for (const auto& pair : g_nearbyNPCsCache) {
+            for (const auto& cachedActor : g_nearbyNPCsCache) {
                 if (count > 0) cachedNames += ", ";
-                cachedNames += pair.second.name;
+                cachedNames += cachedActor.name;
                 count++;
                 if (count >= 10) {
                     cachedNames += "...";
@@ -1877,94 +3167,46 @@ void FindAndCacheNPCRefIDs() {
         return;
     }
 
-    auto* player = RE::PlayerCharacter::GetSingleton();
-    if (!player) {
-        return;
-    }
-
-    auto* processLists = RE::ProcessLists::GetSingleton();
-    if (!processLists) {
+    auto world = GetWorldSnapshot();
+    if (!world) {
         return;
     }
 
-    RE::NiPoint3 playerPos = player->GetPosition();
-
-    for (const auto& npcName : g_detectedNPCNames) {
-        if (g_npcNameToRefID.find(npcName) != g_npcNameToRefID.end()) {
+    for (const auto& detected : g_detectedNPCNames) {
+        if (g_npcNameToRefID.find(detected.nameID) != g_npcNameToRefID.end()) {
             continue;
         }
 
-        bool found = false;
-        std::string normalizedSearchName = NormalizeName(npcName);
-
-        auto searchInList = [&](auto& actorHandles) -> bool {
-            for (auto& actorHandle : actorHandles) {
-                auto actor = actorHandle.get();
-                if (!actor) continue;
-
-                auto* actorBase = actor->GetActorBase();
-                if (!actorBase) continue;
-
-                std::string actorName = actorBase->GetName();
-                std::string normalizedActorName = NormalizeName(actorName);
-                
-                if (normalizedActorName == normalizedSearchName) {
-                    RE::NiPoint3 npcPos = actor->GetPosition();
-                    float distance = playerPos.GetDistance(npcPos);
-
-                    if (distance <= 1000.0f) {
-                        g_npcNameToRefID[npcName] = actor->GetFormID();
-                        
-                        WriteToActionsLog("NPC RefID cached: " + npcName + " = 0x" + 
-                            std::to_string(actor->GetFormID()), __LINE__);
-                        return true;
-                    }
-                }
+        bool found = world->ForEachNearPlayer(kNPCRefIDSearchRadius, {}, [&](uint32_t i) {
+            if (world->nameIDs[i] != detected.nameID) {
+                return false;
             }
-            return false;
-        };
-
-        if (searchInList(processLists->highActorHandles)) {
-            found = true;
-        } else if (searchInList(processLists->middleHighActorHandles)) {
-            found = true;
-        } else if (searchInList(processLists->lowActorHandles)) {
-            found = true;
-        }
+            g_npcNameToRefID[detected.nameID] = world->refIDs[i];
+            
+            WriteToActionsLog("NPC RefID cached: " + detected.name + " = 0x" + 
+                std::to_string(world->refIDs[i]), __LINE__);
+            return true;
+        });
 
         if (!found) {
             if (g_config.notification.enabled) {
-                std::string msg = "ORisk-and-Reward - " + npcName + " apparently it's like a ghost";
+                std::string msg = "ORisk-and-Reward - " + detected.name + " apparently it's like a ghost";
                 RE::DebugNotification(msg.c_str());
             }
         }
     }
 }
 
-ActorInfo* FindActorInfo(const std::string& actorName) {
-    for (auto& actorInfo : g_sceneActors) {
-        if (actorInfo.name == actorName) {
-            return &actorInfo;
-        }
-    }
-    return nullptr;
+const ActorInfo* FindActorInfo(const std::string& actorName) {
+    return g_sceneActors.FindByName(actorName);
 }
 
 bool IsActorFromPlugin(RE::FormID actorFormID, const std::string& pluginName) {
-    auto* dataHandler = RE::TESDataHandler::GetSingleton();
-    if (!dataHandler) return false;
-    
-    auto* file = dataHandler->LookupModByName(pluginName);
-    if (!file) return false;
+    auto plugins = GetPluginIndex();
+    if (!plugins) return false;
     
-    uint8_t modIndex = file->compileIndex;
-    if (modIndex == 0xFF) {
-        modIndex = file->smallFileCompileIndex;
-    }
-    
-    uint8_t actorModIndex = (actorFormID >> 24) & 0xFF;
-    
-    return (actorModIndex == modIndex);
+    auto* plugin = plugins->Find(pluginName);
+    return plugin && plugin->Contains(actorFormID);
 }
 
 std::string GetSpellSystemName(SpellSystemType type) {
@@ -2001,8 +3243,6 @@ int GetActorFactionRank(RE::Actor* actor, RE::TESFaction* faction) {
 }
 
 ActiveSpellEffect* FindActiveEffect(RE::FormID actorFormID, bool isNPCCast, SpellSystemType systemType) {
-    std::lock_guard<std::mutex> lock(g_effectsMutex);
-    
     for (auto& effect : g_activeSpellEffects) {
         if (effect.actorFormID == actorFormID && effect.isNPCCast == isNPCCast && effect.systemType == systemType) {
             return &effect;
@@ -2012,8 +3252,6 @@ ActiveSpellEffect* FindActiveEffect(RE::FormID actorFormID, bool isNPCCast, Spel
 }
 
 void RemoveActiveEffect(RE::FormID actorFormID, bool isNPCCast, SpellSystemType systemType) {
-    std::lock_guard<std::mutex> lock(g_effectsMutex);
-    
     for (auto it = g_activeSpellEffects.begin(); it != g_activeSpellEffects.end(); ++it) {
         if (it->actorFormID == actorFormID && it->isNPCCast == isNPCCast && it->systemType == systemType) {
             std::string systemName = GetSpellSystemName(systemType);
@@ -2522,8 +3760,6 @@ RE::FormID GetCachedFactionFormID(SpellSystemType systemType) {
 }
 
 bool CanApplySpellEffect(RE::FormID actorFormID, bool isNPCCast, SpellSystemType systemType, bool wouldBeTagBased) {
-    std::lock_guard<std::mutex> lock(g_effectsMutex);
-    
     for (const auto& effect : g_activeSpellEffects) {
         if (effect.actorFormID == actorFormID && effect.isNPCCast == isNPCCast && effect.systemType == systemType) {
             return false;
@@ -2537,12 +3773,15 @@ void ApplySpellEffect(RE::FormID actorFormID, bool isPlayer, bool isNPCCast, Spe
     std::string actorName = "";
     std::string gender = "";
     
-    for (const auto& sceneActor : g_sceneActors) {
-        if (sceneActor.refID == actorFormID) {
-            actorName = sceneActor.name;
-            gender = sceneActor.gender;
-            break;
-        }
+    std::shared_ptr<const SceneSnapshot> snapshot;
+    if (!t_sceneStrand) {
+        snapshot = GetSceneSnapshot();
+    }
+    
+    const ActorTable& sceneActors = snapshot ? snapshot->actors : g_sceneActors;
+    if (const ActorInfo* sceneActor = sceneActors.Find(actorFormID)) {
+        actorName = sceneActor->name;
+        gender = sceneActor->gender;
     }
     
     if (actorName.empty()) {
@@ -2564,6 +3803,20 @@ void ApplySpellEffect(RE::FormID actorFormID, bool isPlayer, bool isNPCCast, Spe
     WriteToActionsLog("FormID: 0x" + std::to_string(actorFormID), __LINE__);
     WriteToActionsLog("Is NPC Cast: " + std::string(isNPCCast ? "Yes" : "No"), __LINE__);
     
+    if (t_replayThread) {
+        RecordReplayDecision("SPELL", systemName + "|" + actorName + "|" + (isNPCCast ? "NPC" : "Player"));
+        WriteToActionsLog("Replay mode - spell cast skipped", __LINE__);
+        WriteToActionsLog("========================================", __LINE__);
+        return;
+    }
+    
+    LatencyTrace trace;
+    bool traced = t_latencyTrace != nullptr;
+    if (traced) {
+        trace = *t_latencyTrace;
+        trace.Mark(LatencyStage::RulesEvaluated);
+    }
+    
     RE::FormID spellID = GetCachedSpellFormID(isNPCCast, systemType);
     
     if (spellID == 0) {
@@ -2584,7 +3837,11 @@ void ApplySpellEffect(RE::FormID actorFormID, bool isPlayer, bool isNPCCast, Spe
         return;
     }
     
-    task->AddTask([spellID, actorFormID, actorName, systemName]() {
+    if (traced) {
+        trace.Mark(LatencyStage::TaskQueued);
+    }
+    
+    task->AddTask([spellID, actorFormID, actorName, systemName, trace, traced]() mutable {
         auto* player = RE::PlayerCharacter::GetSingleton();
         if (!player) return;
         
@@ -2597,6 +3854,10 @@ void ApplySpellEffect(RE::FormID actorFormID, bool isPlayer, bool isNPCCast, Spe
         auto* magicCaster = player->GetMagicCaster(RE::MagicSystem::CastingSource::kInstant);
         if (magicCaster) {
             magicCaster->CastSpellImmediate(spell, false, targetActor, 1.0f, false, 0.0f, targetActor);
+            if (traced) {
+                trace.Mark(LatencyStage::TaskExecuted);
+                RecordSpellCastLatency(trace);
+            }
             WriteToActionsLog(systemName + " spell cast SUCCESSFULLY for: " + actorName, __LINE__);
         }
     });
@@ -2606,8 +3867,6 @@ void ApplySpellEffect(RE::FormID actorFormID, bool isPlayer, bool isNPCCast, Spe
 }
 
 void RegisterActiveEffect(RE::FormID actorFormID, const std::string& actorName, bool isPlayer, bool isNPCCast, const std::string& gender, int durationSeconds, bool isTagBased, SpellSystemType systemType) {
-    std::lock_guard<std::mutex> lock(g_effectsMutex);
-    
     ActiveSpellEffect effect;
     effect.actorFormID = actorFormID;
     effect.actorName = actorName;
@@ -2636,8 +3895,6 @@ void CheckExpiredSpellEffects() {
         return;
     }
     
-    std::lock_guard<std::mutex> lock(g_effectsMutex);
-    
     auto now = std::chrono::steady_clock::now();
     
     for (auto it = g_activeSpellEffects.begin(); it != g_activeSpellEffects.end();) {
@@ -2675,7 +3932,6 @@ void CheckExpiredSpellEffects() {
 }
 
 void DeactivateAllSpellEffects() {
-    std::lock_guard<std::mutex> lock(g_effectsMutex);
     WriteToOStimEventsLog("Clearing internal spell systems tracking", __LINE__);
     g_activeSpellEffects.clear();
 }
@@ -2910,7 +4166,12 @@ void CleanupSpellEffectsByFaction() {
     WriteToOStimEventsLog("  Total failed removals: " + std::to_string(totalFailedRemovals), __LINE__);
     WriteToOStimEventsLog("========================================", __LINE__);
 }
-void CleanupTagBasedEffectsAtSceneStart() {
+void CleanupTagBasedEffectsAtSceneStart(const std::vector<ActorInfo>& actors) {
+    if (t_replayThread) {
+        RecordReplayDecision("CLEANUP", "scene start|" + std::to_string(actors.size()));
+        return;
+    }
+    
     WriteToOStimEventsLog("========================================", __LINE__);
     WriteToOStimEventsLog("SCENE START CLEANUP - TAG-BASED EFFECTS", __LINE__);
     
@@ -2946,7 +4207,7 @@ void CleanupTagBasedEffectsAtSceneStart() {
         int actorsInFaction = 0;
         int successfulRemovals = 0;
         
-        for (const auto& actorInfo : g_sceneActors) {
+        for (const auto& actorInfo : actors) {
             totalActorsChecked++;
 
             auto* actor = RE::TESForm::LookupByID<RE::Actor>(actorInfo.refID);
@@ -3018,18 +4279,19 @@ void OnOStimOrgasmEventForSpellSystems(const std::string& actorName, RE::FormID
     
     bool isVampire = false;
     
-    for (const auto& sceneActor : g_sceneActors) {
-        if (sceneActor.refID == actorFormID || NormalizeName(sceneActor.name) == NormalizeName(actorName)) {
-            isVampire = sceneActor.isVampire;
-            WriteToOStimEventsLog("Vampire status from sceneActors: " + actorName + " = " + (isVampire ? "YES" : "NO"), __LINE__);
-            break;
-        }
+    const ActorInfo* sceneActor = g_sceneActors.Find(actorFormID);
+    if (!sceneActor) {
+        sceneActor = g_sceneActors.FindByName(actorName);
+    }
+    if (sceneActor) {
+        isVampire = sceneActor->isVampire;
+        WriteToOStimEventsLog("Vampire status from sceneActors: " + actorName + " = " + (isVampire ? "YES" : "NO"), __LINE__);
     }
     
     if (!isVampire) {
         auto* actor = RE::TESForm::LookupByID<RE::Actor>(actorFormID);
         if (actor) {
-            isVampire = IsActorVampire(actor);
+            isVampire = (ClassifyActor(actor) & kActorClassVampire) != 0;
             WriteToOStimEventsLog("Vampire status from direct check: " + actorName + " = " + (isVampire ? "YES" : "NO"), __LINE__);
         }
     }
@@ -3126,13 +4388,15 @@ void OnOStimOrgasmEventForSpellSystems(const std::string& actorName, RE::FormID
 }
 
 // ===== FIXED VAMPIRE TEARS SYSTEM WITH PROPER VAMPIRE DETECTION FOR TAG-BASED ACTIVATION =====
-void CheckAnimationTagsForSingleActor(const ActorInfo& actorInfo, const std::string& animationName, const std::vector<std::string>& detectedTags) {
+void CheckAnimationTagsForSingleActor(const ActorInfo& actorInfo, const std::string& animationName) {
     if (!IsInOStimScene()) {
         return;
     }
     
     LoadConfiguration();
     
+    SceneAnalysis analysis = GetSceneAnalysis(animationName);
+
     bool isPlayer = (actorInfo.refID == 0x14);
     
     bool isVampire = actorInfo.isVampire;
@@ -3206,7 +4470,7 @@ void CheckAnimationTagsForSingleActor(const ActorInfo& actorInfo, const std::str
             continue;
         }
         
-        bool matchesTags = MatchesConfiguredTags(animationName, detectedTags, tagsList);
+        bool matchesTags = analysis.Matches(systemType, isPlayer);
         bool genderMatches = MatchesGenderFilter(actorInfo.gender, tagsGender);
         
         if (matchesTags && genderMatches) {
@@ -3231,7 +4495,7 @@ void CheckAnimationTagsForSingleActor(const ActorInfo& actorInfo, const std::str
 }
 
 // ===== FIXED VAMPIRE TEARS SYSTEM WITH PROPER VAMPIRE DETECTION FOR TAG-BASED SYSTEM =====
-void CheckAnimationTagsForSpellSystems(const std::string& animationName, const std::vector<std::string>& detectedTags) {
+void CheckAnimationTagsForSpellSystems(const std::string& animationName) {
     if (!IsInOStimScene()) {
         return;
     }
@@ -3245,6 +4509,8 @@ void CheckAnimationTagsForSpellSystems(const std::string& animationName, const s
     LoadConfiguration();
     CheckVampireTearsPluginAvailability();
     
+    SceneAnalysis analysis = GetSceneAnalysis(animationName);
+
     WriteToOStimEventsLog("========================================", __LINE__);
     WriteToOStimEventsLog("CHECKING ANIMATION TAGS FOR ALL SPELL SYSTEMS", __LINE__);
     WriteToOStimEventsLog("Animation: " + animationName, __LINE__);
@@ -3323,7 +4589,7 @@ void CheckAnimationTagsForSpellSystems(const std::string& animationName, const s
                 continue;
             }
             
-            bool matchesTags = MatchesConfiguredTags(animationName, detectedTags, tagsList);
+            bool matchesTags = analysis.Matches(systemType, isPlayer);
             bool genderMatches = MatchesGenderFilter(actorInfo.gender, tagsGender);
             
             if (matchesTags && genderMatches) {
@@ -3365,8 +4631,6 @@ void CheckAnimationTagsForSpellSystems(const std::string& animationName, const s
 }
 
 void RemoveTagBasedSpellEffects() {
-    std::lock_guard<std::mutex> lock(g_effectsMutex);
-    
     g_lastProcessedAnimationForTags = "";
     
     LoadConfiguration();
@@ -3397,11 +4661,7 @@ void RemoveTagBasedSpellEffects() {
             }
             
             if (!tagsList.empty()) {
-                stillMatches = AnimationStillHasConfiguredTags(
-                    g_currentAnimationInfo.animationName, 
-                    g_currentAnimationInfo.implicitTags, 
-                    tagsList
-                );
+                stillMatches = GetSceneAnalysis(g_currentAnimationInfo.animationName).Matches(it->systemType, !it->isNPCCast);
             }
             
             if (stillMatches) {
@@ -3432,8 +4692,6 @@ void RemoveTagBasedSpellEffects() {
 }
 
 void ProcessPendingSpellCasts() {
-    std::lock_guard<std::mutex> lock(g_pendingSpellMutex);
-    
     if (g_pendingSpellCasts.empty()) {
         return;
     }
@@ -3699,13 +4957,11 @@ void ParseOStimEventFromLine(const std::string& line) {
                 speedStr = speedStr.substr(0, speedStr.find_first_not_of("0123456789"));
                 int newSpeed = std::stoi(speedStr);
                 
-                if (newSpeed != g_currentOStimSpeed) {
-                    g_currentOStimSpeed = newSpeed;
-                    
-                    std::vector<std::string> speedNames = {"Slow", "Medium", "Fast", "Rough"};
+                if (g_sceneTagStats.SetSpeed(newSpeed, std::chrono::steady_clock::now())) {
+                    constexpr std::array<const char*, 4> speedNames = {"Slow", "Medium", "Fast", "Rough"};
                     std::string speedName = (newSpeed >= 0 && newSpeed < static_cast<int>(speedNames.size())) 
                         ? speedNames[newSpeed] : "Unknown";
-                    
+
                     WriteToOStimEventsLog("========================================", __LINE__);
                     WriteToOStimEventsLog("SPEED CHANGE EVENT", __LINE__);
                     WriteToOStimEventsLog("New speed: " + speedName + " (Level " + std::to_string(newSpeed) + ")", __LINE__);
@@ -3729,31 +4985,12 @@ void ParseOStimEventFromLine(const std::string& line) {
                 metadata.erase(metadata.find_last_not_of(" \t") + 1);
                 
                 if (!metadata.empty()) {
-                    bool alreadyTagged = false;
-                    for (const auto& tag : g_currentOStimTags) {
-                        if (tag == metadata) {
-                            alreadyTagged = true;
-                            break;
-                        }
-                    }
+                    uint32_t tagID = TagNameTable::Get().Intern(metadata);
                     
-                    if (!alreadyTagged) {
-                        g_currentOStimTags.push_back(metadata);
-                        
-                        WriteToOStimEventsLog("========================================", __LINE__);
-                        WriteToOStimEventsLog("TAG DETECTED EVENT", __LINE__);
-                        WriteToOStimEventsLog("Tag: " + metadata, __LINE__);
-                        WriteToOStimEventsLog("Current animation: " + GetLastAnimation(), __LINE__);
-                        
-                        std::string allTags = "All current tags: ";
-                        for (size_t i = 0; i < g_currentOStimTags.size(); i++) {
-                            allTags += g_currentOStimTags[i];
-                            if (i < g_currentOStimTags.size() - 1) {
-                                allTags += ", ";
-                            }
-                        }
-                        WriteToOStimEventsLog(allTags, __LINE__);
-                        WriteToOStimEventsLog("========================================", __LINE__);
+                    if (g_sceneTagStats.AddTag(tagID, std::chrono::steady_clock::now())) {
+                        WriteToOStimEventsLog("TAG DETECTED EVENT: " + metadata + " | Animation: " + GetLastAnimation() +
+                                                  " | Active tags: " + std::to_string(g_sceneTagStats.tags.Count()),
+                                              __LINE__);
                     }
                 }
             }
@@ -3761,9 +4998,10 @@ void ParseOStimEventFromLine(const std::string& line) {
     }
     
     if (line.find("[Thread.cpp:195] thread 0 changed to node") != std::string::npos) {
-        g_currentOStimTags.clear();
-        g_currentOStimSpeed = 0;
-        
+        auto now = std::chrono::steady_clock::now();
+        g_sceneTagStats.ClearTags(now);
+        g_sceneTagStats.SetSpeed(0, now);
+
         WriteToOStimEventsLog("========================================", __LINE__);
         WriteToOStimEventsLog("ANIMATION CHANGE EVENT", __LINE__);
         WriteToOStimEventsLog("Animation changed - tags and speed reset", __LINE__);
@@ -3772,45 +5010,6 @@ void ParseOStimEventFromLine(const std::string& line) {
     }
 }
 
-void ProcessOStimEventData() {
-    if (!IsInOStimScene()) {
-        return;
-    }
-    
-    GenerateTagsReport();
-    
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - g_lastOStimEventCheck).count();
-    
-    if (elapsed < 5) {
-        return;
-    }
-    
-    g_lastOStimEventCheck = now;
-    
-    if (!g_currentOStimTags.empty() || g_currentOStimSpeed > 0) {
-        WriteToOStimEventsLog("========================================", __LINE__);
-        WriteToOStimEventsLog("PERIODIC STATUS UPDATE", __LINE__);
-        WriteToOStimEventsLog("Current animation: " + GetLastAnimation(), __LINE__);
-        WriteToOStimEventsLog("Current speed level: " + std::to_string(g_currentOStimSpeed), __LINE__);
-        
-        if (!g_currentOStimTags.empty()) {
-            std::string tagsStr = "Active tags: ";
-            for (size_t i = 0; i < g_currentOStimTags.size(); i++) {
-                tagsStr += g_currentOStimTags[i];
-                if (i < g_currentOStimTags.size() - 1) {
-                    tagsStr += ", ";
-                }
-            }
-            WriteToOStimEventsLog(tagsStr, __LINE__);
-        } else {
-            WriteToOStimEventsLog("Active tags: None", __LINE__);
-        }
-        
-        WriteToOStimEventsLog("========================================", __LINE__);
-    }
-}
-
 class OStimModEventSink : public RE::BSTEventSink<SKSE::ModCallbackEvent> {
 public:
     static OStimModEventSink& GetSingleton() {
@@ -3824,54 +5023,160 @@ public:
             return RE::BSEventNotifyControl::kContinue;
         }
 
-        std::string eventName = event->eventName.c_str();
+        OStimEventType type = OStimEventNameTable::Get().Classify(event->eventName);
+        if (type == OStimEventType::Unknown && !OStimEventNameTable::IsOStimEvent(event->eventName)) {
+            return RE::BSEventNotifyControl::kContinue;
+        }
+
+        QueuedModEvent queued;
+        queued.receivedTime = std::chrono::steady_clock::now();
+        queued.type = type;
+        queued.eventName = event->eventName;
+        queued.strArg = event->strArg;
+        queued.numArg = event->numArg;
+        queued.senderFormID = event->sender ? event->sender->GetFormID() : 0;
+
+        if (g_modEventQueue.TryEnqueue(queued)) {
+            g_eventQueueSignal.fetch_add(1, std::memory_order_release);
+            g_eventQueueSignal.notify_one();
+        } else {
+            g_eventQueueDropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        auto enqueueNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - queued.receivedTime)
+                             .count();
+        g_eventEnqueueNsHistogram.Record(static_cast<uint64_t>(enqueueNs));
+        g_eventQueueDepthHistogram.Record(g_modEventQueue.ApproximateDepth());
+
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    void ProcessQueuedEvent(ParsedModEvent& event) {
+        using Handler = void (OStimModEventSink::*)(const ParsedModEvent&);
+        static constexpr std::array<Handler, static_cast<size_t>(OStimEventType::Count)> handlers = {
+            nullptr,
+            &OStimModEventSink::HandleThreadPrestart,
+            &OStimModEventSink::HandleThreadPrestart,
+            &OStimModEventSink::HandleSceneChange,
+            &OStimModEventSink::HandleThreadSceneChange,
+            &OStimModEventSink::HandleSpeedChange,
+            &OStimModEventSink::HandleOrgasm,
+            &OStimModEventSink::HandleOrgasm,
+            &OStimModEventSink::HandleThreadEnd,
+            &OStimModEventSink::HandleThreadEnd,
+            &OStimModEventSink::HandleThreadEnd};
+        
+        LatencyTrace trace;
+        trace.source = static_cast<size_t>(event.type);
+        trace.Mark(LatencyStage::Received, event.receivedTime);
+        trace.Mark(LatencyStage::Dequeued);
+        RecordLatencyInterval(trace.source, LatencyInterval::QueueWait, trace, LatencyStage::Received,
+                              LatencyStage::Dequeued);
+        t_latencyTrace = &trace;
+        
+        ParseModEventPayload(event);
+        LogEventBasicInfo(event);
+        if (event.type == OStimEventType::Unknown) {
+            WriteToOStimEventsLog("Unrecognized OStim event - logged only", __LINE__);
+        }
+        
+        int threadID = GetEventThreadID(event);
+        if (threadID > 0) {
+            HandleNPCThreadEvent(event, threadID);
+            t_latencyTrace = nullptr;
+            return;
+        }
         
-        if (eventName.find("ostim_") == 0) {
-            LogEventBasicInfo(event);
-            
-            if (eventName == "ostim_prestart" || eventName == "ostim_thread_start") {
-                HandleThreadPrestart(event);
-            }
-            else if (eventName.find("ostim_scenechanged_") == 0) {
-                HandleSceneChange(event);
-            }
-            else if (eventName == "ostim_thread_scenechanged") {
-                HandleThreadSceneChange(event);
-            }
-            else if (eventName == "ostim_thread_speedchanged") {
-                HandleSpeedChange(event);
-            }
-            else if (eventName == "ostim_orgasm" || eventName == "ostim_actor_orgasm") {
-                HandleOrgasm(event);
-            }
-            else if (eventName == "ostim_end" || eventName == "ostim_totalend" || eventName == "ostim_thread_end") {
-                HandleThreadEnd(event);
-            }
-            
-            auto tags = TagAnalyzer::ExtractTagsFromEventData(event);
-            if (!tags.empty()) {
-                LogDetectedTags(tags, eventName);
-            }
+        Handler handler = handlers[static_cast<size_t>(event.type)];
+        if (handler) {
+            (this->*handler)(event);
         }
         
-        return RE::BSEventNotifyControl::kContinue;
+        if (event.type == OStimEventType::ThreadStart || event.type == OStimEventType::ThreadSceneChanged) {
+            CollectSceneActorsFromEvent(event);
+        }
+        
+        t_latencyTrace = nullptr;
+        
+        TagSet tags = TagAnalyzer::ExtractTagsFromEventData(event);
+        if (!tags.Empty()) {
+            LogDetectedTags(tags, event.eventName.c_str());
+        }
     }
 
 private:
-    void LogEventBasicInfo(const SKSE::ModCallbackEvent* event) {
-        std::string eventName = event->eventName.c_str();
+    void CollectSceneActorsFromEvent(const ParsedModEvent& event) {
+        auto* sender = event.senderFormID != 0 ? RE::TESForm::LookupByID(event.senderFormID) : nullptr;
+        if (sender) {
+            AddSceneActorFromEvent(sender->As<RE::Actor>(), "event sender");
+        }
+        
+        for (RE::FormID formID : GetEventActors(event)) {
+            auto* actor = RE::TESForm::LookupByID<RE::Actor>(formID);
+            if (!actor) {
+                WriteToOStimEventsLog("Event actor FormID 0x" + std::to_string(formID) + " not found", __LINE__);
+                continue;
+            }
+            AddSceneActorFromEvent(actor, "event payload");
+        }
+    }
+    
+    void HandleNPCThreadEvent(const ParsedModEvent& event, int threadID) {
+        auto* sender = event.senderFormID != 0 ? RE::TESForm::LookupByID(event.senderFormID) : nullptr;
+        RE::Actor* senderActor = sender ? sender->As<RE::Actor>() : nullptr;
+        
+        switch (event.type) {
+            case OStimEventType::ThreadStart:
+                AddThreadActor(threadID, senderActor);
+                for (RE::FormID formID : GetEventActors(event)) {
+                    AddThreadActor(threadID, RE::TESForm::LookupByID<RE::Actor>(formID));
+                }
+                break;
+            case OStimEventType::ThreadSceneChanged:
+                {
+                    std::string sceneID = GetEventSceneID(event);
+                    if (!sceneID.empty()) {
+                        UpdateThreadAnimation(threadID, sceneID, "Mod Event");
+                    }
+                }
+                for (RE::FormID formID : GetEventActors(event)) {
+                    AddThreadActor(threadID, RE::TESForm::LookupByID<RE::Actor>(formID));
+                }
+                break;
+            case OStimEventType::ThreadSpeedChanged: {
+                int speed = GetEventSpeed(event);
+                if (speed >= 0) {
+                    UpdateThreadSpeed(threadID, speed);
+                }
+                break;
+            }
+            case OStimEventType::ActorOrgasm:
+                RecordThreadOrgasm(threadID, senderActor);
+                break;
+            case OStimEventType::ThreadEnd:
+                EndThreadState(threadID, "Mod Event");
+                break;
+            default:
+                break;
+        }
+    }
+
+    void LogEventBasicInfo(const ParsedModEvent& event) {
+        const char* eventName = event.eventName.c_str();
         
         WriteToOStimEventsLog("========================================", __LINE__);
         WriteToOStimEventsLog("OSTIM MOD EVENT RECEIVED", __LINE__);
-        WriteToOStimEventsLog("Event Name: " + eventName, __LINE__);
+        WriteToOStimEventsLog(std::string("Event Name: ") + eventName, __LINE__);
         
-        std::string strArg = (event->strArg.c_str() != nullptr && strlen(event->strArg.c_str()) > 0) 
-            ? std::string(event->strArg.c_str()) : "(null)";
+        std::string strArg = (event.strArg.c_str() != nullptr && strlen(event.strArg.c_str()) > 0) 
+            ? std::string(event.strArg.c_str()) : "(null)";
         WriteToOStimEventsLog("String Argument: " + strArg, __LINE__);
-        WriteToOStimEventsLog("Numeric Argument: " + std::to_string(event->numArg), __LINE__);
+        WriteToOStimEventsLog("Numeric Argument: " + std::to_string(event.numArg), __LINE__);
         
-        if (event->sender) {
-            auto* actor = event->sender->As<RE::Actor>();
+        auto* sender = event.senderFormID != 0 ? RE::TESForm::LookupByID(event.senderFormID) : nullptr;
+        if (sender) {
+            auto* actor = sender->As<RE::Actor>();
             if (actor) {
                 auto* base = actor->GetActorBase();
                 if (base) {
@@ -3887,36 +5192,48 @@ private:
         }
         WriteToOStimEventsLog("========================================", __LINE__);
         
-        if (strArg != "(null)" && !strArg.empty()) {
-            WriteToOStimEventsLog("JSON DATA DETECTED IN EVENT: " + eventName, __LINE__);
+        if (strArg != "(null)" && OStimJsonReader::LooksLikeJson(strArg)) {
+            WriteToOStimEventsLog(std::string("JSON DATA DETECTED IN EVENT: ") + eventName, __LINE__);
             WriteToOStimEventsLog("JSON Content: " + strArg, __LINE__);
-        }
-    }
-    
-    void HandleThreadPrestart(const SKSE::ModCallbackEvent* event) {
-        std::string eventName = event->eventName.c_str();
-        
-        if (!IsInOStimScene()) {
-            WriteToOStimEventsLog("========================================", __LINE__);
-            WriteToOStimEventsLog("THREAD PRESTART DETECTED - BUILDING NPC CACHE", __LINE__);
-            WriteToOStimEventsLog("Event Name: " + eventName, __LINE__);
             
-            BuildNPCsCacheForScene();
+            if (!event.hasPayload) {
+                WriteToOStimEventsLog("JSON payload could not be parsed", __LINE__);
+                return;
+            }
+            const OStimEventPayload& payload = event.payload;
             
-            WriteToOStimEventsLog("NPC Cache ready for scene start", __LINE__);
-            WriteToOStimEventsLog("========================================", __LINE__);
+            std::string actorsStr;
+            for (size_t i = 0; i < payload.actorCount; i++) {
+                std::stringstream ss;
+                ss << (i > 0 ? ", " : "") << "0x" << std::hex << std::uppercase << payload.actors[i];
+                actorsStr += ss.str();
+            }
+            std::string tagsStr;
+            for (size_t i = 0; i < payload.tagCount; i++) {
+                tagsStr += (i > 0 ? ", " : "") + std::string(payload.tags[i]);
+            }
+            
+            WriteToOStimEventsLog("Payload Scene ID: " + (payload.sceneID.empty() ? std::string("(none)") : std::string(payload.sceneID)), __LINE__);
+            WriteToOStimEventsLog("Payload Actors: " + (actorsStr.empty() ? std::string("(none)") : actorsStr), __LINE__);
+            WriteToOStimEventsLog("Payload Thread ID: " + std::to_string(payload.threadID), __LINE__);
+            WriteToOStimEventsLog("Payload Speed: " + std::to_string(payload.speed), __LINE__);
+            WriteToOStimEventsLog("Payload Tags: " + (tagsStr.empty() ? std::string("(none)") : tagsStr), __LINE__);
         }
     }
     
-    void HandleSceneChange(const SKSE::ModCallbackEvent* event) {
-        std::string eventName = event->eventName.c_str();
+    void HandleThreadPrestart(const ParsedModEvent& event) {
+        ApplySceneInput({SceneInputKind::Prestart, SceneInputSource::ModEvent, event.receivedTime, ""});
+    }
+    
+    void HandleSceneChange(const ParsedModEvent& event) {
+        std::string eventName = event.eventName.c_str();
         
         if (!IsInOStimScene()) {
             WriteToOStimEventsLog("========================================", __LINE__);
             WriteToOStimEventsLog("THREAD START DETECTED (via ostim_scenechanged_)", __LINE__);
             WriteToOStimEventsLog("Event Name: " + eventName, __LINE__);
             
-            if (eventName.find("ostim_scenechanged_") == 0) {
+            if (event.type == OStimEventType::SceneChanged) {
                 std::string animName = eventName.substr(19);
                 WriteToOStimEventsLog("Animation: " + animName, __LINE__);
                 AnalyzeAnimationForTags(animName);
@@ -3926,13 +5243,12 @@ private:
         }
     }
     
-    void HandleThreadSceneChange(const SKSE::ModCallbackEvent* event) {
+    void HandleThreadSceneChange(const ParsedModEvent& event) {
         WriteToOStimEventsLog("========================================", __LINE__);
         WriteToOStimEventsLog("ANIMATION CHANGE FROM MOD EVENT", __LINE__);
         
-        std::string newAnimationName;
-        if (event->strArg.c_str() != nullptr && strlen(event->strArg.c_str()) > 0) {
-            newAnimationName = std::string(event->strArg.c_str());
+        std::string newAnimationName = GetEventSceneID(event);
+        if (!newAnimationName.empty()) {
             WriteToOStimEventsLog("New Animation: " + newAnimationName, __LINE__);
             
             AnalyzeAnimationForTags(newAnimationName);
@@ -3951,7 +5267,7 @@ private:
         
         if (!anyTagsEnabled) {
             WriteToOStimEventsLog("Tag-based spell systems disabled in config - skipping check", __LINE__);
-            WriteToOStimEventsLog("Thread ID: " + std::to_string(static_cast<int>(event->numArg)), __LINE__);
+            WriteToOStimEventsLog("Thread ID: " + std::to_string(static_cast<int>(event.numArg)), __LINE__);
             WriteToOStimEventsLog("========================================", __LINE__);
             return;
         }
@@ -3959,52 +5275,23 @@ private:
         bool newAnimationMatchesAny = false;
         
         if (!newAnimationName.empty()) {
-            std::vector<std::string> tagsListsToCheck;
-            
-            if (g_config.emotionalTearsNPC.enabled && g_config.emotionalTearsNPC.tagsNameAnimationEnabled) {
-                tagsListsToCheck.push_back(g_config.emotionalTearsNPC.tagsNameAnimationList);
-            }
-            if (g_config.emotionalTearsPlayer.enabled && g_config.emotionalTearsPlayer.tagsNameAnimationEnabled) {
-                tagsListsToCheck.push_back(g_config.emotionalTearsPlayer.tagsNameAnimationList);
-            }
-            if (g_config.vampireTearsNPC.enabled && g_config.vampireTearsNPC.tagsNameAnimationEnabled) {
-                tagsListsToCheck.push_back(g_config.vampireTearsNPC.tagsNameAnimationList);
-            }
-            if (g_config.vampireTearsPlayer.enabled && g_config.vampireTearsPlayer.tagsNameAnimationEnabled) {
-                tagsListsToCheck.push_back(g_config.vampireTearsPlayer.tagsNameAnimationList);
-            }
-            if (g_config.bloodyNoseNPC.enabled && g_config.bloodyNoseNPC.tagsNameAnimationEnabled) {
-                tagsListsToCheck.push_back(g_config.bloodyNoseNPC.tagsNameAnimationList);
-            }
-            if (g_config.bloodyNosePlayer.enabled && g_config.bloodyNosePlayer.tagsNameAnimationEnabled) {
-                tagsListsToCheck.push_back(g_config.bloodyNosePlayer.tagsNameAnimationList);
-            }
-            
-            for (const auto& tagsList : tagsListsToCheck) {
-                if (!tagsList.empty() && MatchesConfiguredTags(newAnimationName, g_currentAnimationInfo.implicitTags, tagsList)) {
-                    newAnimationMatchesAny = true;
-                    break;
-                }
-            }
+            newAnimationMatchesAny = GetSceneAnalysis(newAnimationName).matchBits != 0;
         }
         
         if (!newAnimationMatchesAny) {
             RemoveTagBasedSpellEffects();
         } else {
-            CheckAnimationTagsForSpellSystems(newAnimationName, g_currentAnimationInfo.implicitTags);
+            CheckAnimationTagsForSpellSystems(newAnimationName);
         }
         
-        WriteToOStimEventsLog("Thread ID: " + std::to_string(static_cast<int>(event->numArg)), __LINE__);
+        WriteToOStimEventsLog("Thread ID: " + std::to_string(static_cast<int>(event.numArg)), __LINE__);
         WriteToOStimEventsLog("========================================", __LINE__);
     }
     
-    void HandleSpeedChange(const SKSE::ModCallbackEvent* event) {
-        std::string speedStr = (event->strArg.c_str() != nullptr) ? std::string(event->strArg.c_str()) : "0";
-        int speed = 0;
-        try {
-            speed = std::stoi(speedStr);
-        } catch (...) {
-            speed = static_cast<int>(event->numArg);
+    void HandleSpeedChange(const ParsedModEvent& event) {
+        int speed = GetEventSpeed(event);
+        if (speed < 0) {
+            speed = static_cast<int>(event.numArg);
         }
         
         std::vector<std::string> speedNames = {"Slow", "Medium", "Fast", "Rough", "Climax"};
@@ -4026,102 +5313,47 @@ private:
         WriteToOStimEventsLog("========================================", __LINE__);
     }
 
-    void HandleThreadStart(const SKSE::ModCallbackEvent* event) {
+    void HandleThreadStart(const ParsedModEvent& event) {
         WriteToOStimEventsLog("========================================", __LINE__);
         WriteToOStimEventsLog("OSTIM THREAD START EVENT", __LINE__);
         
-        if (event->strArg.c_str() != nullptr && strlen(event->strArg.c_str()) > 0) {
-            WriteToOStimEventsLog("Scene ID: " + std::string(event->strArg.c_str()), __LINE__);
+        if (event.strArg.c_str() != nullptr && strlen(event.strArg.c_str()) > 0) {
+            WriteToOStimEventsLog("Scene ID: " + std::string(event.strArg.c_str()), __LINE__);
         }
         
-        WriteToOStimEventsLog("Thread ID: " + std::to_string(static_cast<int>(event->numArg)), __LINE__);
+        WriteToOStimEventsLog("Thread ID: " + std::to_string(static_cast<int>(event.numArg)), __LINE__);
         WriteToOStimEventsLog("Current Animation: " + GetLastAnimation(), __LINE__);
         WriteToOStimEventsLog("========================================", __LINE__);
     }
 
-    void HandleThreadEnd(const SKSE::ModCallbackEvent* event) {
+    void HandleThreadEnd(const ParsedModEvent& event) {
         WriteToOStimEventsLog("========================================", __LINE__);
         WriteToOStimEventsLog("OSTIM THREAD END EVENT RECEIVED", __LINE__);
-        WriteToOStimEventsLog("Event Type: " + std::string(event->eventName.c_str()), __LINE__);
-        WriteToOStimEventsLog("Thread ID: " + std::to_string(static_cast<int>(event->numArg)), __LINE__);
+        WriteToOStimEventsLog("Event Type: " + std::string(event.eventName.c_str()), __LINE__);
+        WriteToOStimEventsLog("Thread ID: " + std::to_string(static_cast<int>(event.numArg)), __LINE__);
         
-        if (IsInOStimScene()) {
-            WriteToOStimEventsLog("OStim scene is currently active - initiating cleanup", __LINE__);
-            WriteToOStimEventsLog("Actors in scene: " + std::to_string(g_sceneActors.size()), __LINE__);
-            
-            std::vector<ActorInfo> sceneActorsCopy = g_sceneActors;
-        
-            for (const auto& actor : sceneActorsCopy) {
-                WriteToOStimEventsLog("Actor to verify: " + actor.name + " (RefID: 0x" + 
-                    std::to_string(actor.refID) + ")", __LINE__);
-            }
-        
-            g_sceneEndTime = std::chrono::steady_clock::now();
-            g_cleanupPending = true;
-            
-            WriteToOStimEventsLog("Cleanup scheduled with 1-second delay to avoid OStim collision", __LINE__);
-            
-            g_currentOStimTags.clear();
-            g_currentOStimSpeed = 0;
-            g_currentAnimationInfo = AnimationTagInfo{};
-            
-            SetInOStimScene(false);
-            
-            g_goldRewardActive = false;
-            g_item1RewardActive = false;
-            g_item2RewardActive = false;
-            g_milkRewardActive = false;
-            g_milkWenchRewardActive = false;
-            g_milkEthelRewardActive = false;
-            g_attributesRestorationActive = false;
-            
-            g_detectedNPCNames.clear();
-            g_npcNameToRefID.clear();
-            
-            {
-                std::lock_guard<std::mutex> lock(g_orgasmMutex);
-                g_lastOrgasmTimestamps.clear();
-            }
-            
-            ClearOrgasmCounters();
-            ClearBloodyNoseCounters();
-            
-            {
-                std::lock_guard<std::mutex> lock(g_pendingSpellMutex);
-                if (!g_pendingSpellCasts.empty()) {
-                    WriteToOStimEventsLog("Clearing " + std::to_string(g_pendingSpellCasts.size()) + 
-                                         " pending spell casts (scene ended)", __LINE__);
-                    g_pendingSpellCasts.clear();
-                }
-            }
-            
-            g_sceneActors.clear();
-            g_lastProcessedAnimationForTags = "";
-            
-            WriteToOStimEventsLog("All reward systems stopped", __LINE__);
-            WriteToOStimEventsLog("Scene state cleared successfully", __LINE__);
-            WriteToOStimEventsLog("g_sceneActors cleared", __LINE__);
-            WriteToActionsLog("OStim scene ended via Mod Event - all systems stopped and spell effects deactivated", __LINE__);
-            
-        } else {
+        SceneState previousState =
+            ApplySceneInput({SceneInputKind::End, SceneInputSource::ModEvent, event.receivedTime, ""});
+        if (previousState != SceneState::Active) {
             WriteToOStimEventsLog("Thread end event received but no active scene detected", __LINE__);
         }
         
         WriteToOStimEventsLog("========================================", __LINE__);
     }
 
-    void HandleOrgasm(const SKSE::ModCallbackEvent* event) {
+    void HandleOrgasm(const ParsedModEvent& event) {
         WriteToOStimEventsLog("========================================", __LINE__);
         WriteToOStimEventsLog("ORGASM EVENT DETECTED", __LINE__);
-        WriteToOStimEventsLog("Event Type: " + std::string(event->eventName.c_str()), __LINE__);
+        WriteToOStimEventsLog("Event Type: " + std::string(event.eventName.c_str()), __LINE__);
         
         std::string actorName = "";
         RE::FormID actorFormID = 0;
         bool isPlayer = false;
         std::string gender = "";
         
-        if (event->sender) {
-            auto* actor = event->sender->As<RE::Actor>();
+        auto* sender = event.senderFormID != 0 ? RE::TESForm::LookupByID(event.senderFormID) : nullptr;
+        if (sender) {
+            auto* actor = sender->As<RE::Actor>();
             if (actor) {
                 auto* base = actor->GetActorBase();
                 if (base) {
@@ -4162,224 +5394,2012 @@ private:
     }
 };
 
-class GameEventProcessor : public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
-    GameEventProcessor() = default;
-    ~GameEventProcessor() = default;
-    GameEventProcessor(const GameEventProcessor&) = delete;
-    GameEventProcessor(GameEventProcessor&&) = delete;
-    GameEventProcessor& operator=(const GameEventProcessor&) = delete;
-    GameEventProcessor& operator=(GameEventProcessor&&) = delete;
+void DumpEventQueueStats(const std::string& reason) {
+    WriteToOStimEventsLog("========================================", __LINE__);
+    WriteToOStimEventsLog("MOD EVENT QUEUE STATS (" + reason + ")", __LINE__);
+    WriteToOStimEventsLog("Enqueue cost ns: " + g_eventEnqueueNsHistogram.Summary(), __LINE__);
+    WriteToOStimEventsLog("Queue depth: " + g_eventQueueDepthHistogram.Summary(), __LINE__);
+    WriteToOStimEventsLog("JSON payload parse ns: " + g_payloadParseNsHistogram.Summary(), __LINE__);
+    WriteToOStimEventsLog("Dropped (queue full): " + std::to_string(g_eventQueueDropped.load()), __LINE__);
+    uint64_t analysisHits = g_sceneAnalysisHits.load(std::memory_order_relaxed);
+    uint64_t analysisMisses = g_sceneAnalysisMisses.load(std::memory_order_relaxed);
+    uint64_t analysisLookups = analysisHits + analysisMisses;
+    WriteToOStimEventsLog("Scene analysis cache: " + std::to_string(analysisHits) + " hits, " +
+                              std::to_string(analysisMisses) + " misses (" +
+                              std::to_string(analysisLookups > 0 ? analysisHits * 100 / analysisLookups : 0) +
+                              "% hit rate, config version " + std::to_string(g_configVersion.load()) + ")",
+                          __LINE__);
+    WriteToOStimEventsLog("Actor identity cache: " + g_actorIdentityCache.Summary(), __LINE__);
+    WriteToOStimEventsLog("Actor names interned: " + std::to_string(ActorNameTable::Get().Size()), __LINE__);
+    WriteToOStimEventsLog("Interned OStim tags: " + std::to_string(TagNameTable::Get().InternedCount()) + " (" +
+                              std::to_string(TagNameTable::Get().OverflowCount()) + " beyond the tag set)",
+                          __LINE__);
+    WriteToOStimEventsLog("========================================", __LINE__);
+}
 
-public:
-    static GameEventProcessor& GetSingleton() {
-        static GameEventProcessor singleton;
-        return singleton;
+const char* GetLatencySourceName(size_t source) {
+    switch (source) {
+        case static_cast<size_t>(OStimEventType::Prestart): return "ostim_prestart";
+        case static_cast<size_t>(OStimEventType::ThreadStart): return "ostim_thread_start";
+        case static_cast<size_t>(OStimEventType::SceneChanged): return "ostim_scenechanged_*";
+        case static_cast<size_t>(OStimEventType::ThreadSceneChanged): return "ostim_thread_scenechanged";
+        case static_cast<size_t>(OStimEventType::ThreadSpeedChanged): return "ostim_thread_speedchanged";
+        case static_cast<size_t>(OStimEventType::Orgasm): return "ostim_orgasm";
+        case static_cast<size_t>(OStimEventType::ActorOrgasm): return "ostim_actor_orgasm";
+        case static_cast<size_t>(OStimEventType::End): return "ostim_end";
+        case static_cast<size_t>(OStimEventType::TotalEnd): return "ostim_totalend";
+        case static_cast<size_t>(OStimEventType::ThreadEnd): return "ostim_thread_end";
+        case kLatencySourceOStimLog: return "OStim.log line";
+        default: return "unknown";
     }
+}
 
-    RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* event,
-                                          RE::BSTEventSource<RE::MenuOpenCloseEvent>*) override {
-        if (event) {
-            std::stringstream msg;
-            msg << "Menu " << event->menuName.c_str() << " " << (event->opening ? "opened" : "closed");
-            WriteToActionsLog(msg.str(), __LINE__);
-        }
-        return RE::BSEventNotifyControl::kContinue;
+const char* GetLatencyIntervalName(LatencyInterval interval) {
+    switch (interval) {
+        case LatencyInterval::QueueWait: return "received -> dequeued";
+        case LatencyInterval::RulesEvaluation: return "dequeued -> rules evaluated";
+        case LatencyInterval::TaskQueueing: return "rules evaluated -> task queued";
+        case LatencyInterval::TaskExecution: return "task queued -> task executed";
+        case LatencyInterval::EndToEnd: return "received -> task executed";
+        default: return "unknown";
     }
-};
+}
 
-bool DetectSceneEnd(const std::string& line) {
-    if (line.find("[Thread.cpp:634] closing thread") != std::string::npos) {
-        WriteToAnimationsLog("DETECTED: OStim thread closing", __LINE__);
-        return true;
-    }
-    if (line.find("[ThreadManager.cpp:174] trying to stop thread") != std::string::npos) {
-        WriteToAnimationsLog("DETECTED: OStim trying to stop thread", __LINE__);
-        return true;
+void RecordLatencyInterval(size_t source, LatencyInterval interval, const LatencyTrace& trace, LatencyStage from, LatencyStage to) {
+    if (source >= kLatencySourceCount) {
+        return;
     }
-    return false;
+    auto elapsed = trace.stamps[static_cast<size_t>(to)] - trace.stamps[static_cast<size_t>(from)];
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    g_latencyHistograms[source][static_cast<size_t>(interval)].Record(micros > 0 ? static_cast<uint64_t>(micros) : 0);
 }
 
-std::string DetectAnimationChange(const std::string& line) {
-    std::string animationName;
+void RecordSpellCastLatency(const LatencyTrace& trace) {
+    RecordLatencyInterval(trace.source, LatencyInterval::RulesEvaluation, trace, LatencyStage::Dequeued,
+                          LatencyStage::RulesEvaluated);
+    RecordLatencyInterval(trace.source, LatencyInterval::TaskQueueing, trace, LatencyStage::RulesEvaluated,
+                          LatencyStage::TaskQueued);
+    RecordLatencyInterval(trace.source, LatencyInterval::TaskExecution, trace, LatencyStage::TaskQueued,
+                          LatencyStage::TaskExecuted);
+    RecordLatencyInterval(trace.source, LatencyInterval::EndToEnd, trace, LatencyStage::Received,
+                          LatencyStage::TaskExecuted);
+}
 
-    if (line.find("[info]") != std::string::npos &&
-        line.find("[Thread.cpp:195] thread 0 changed to node") != std::string::npos) {
-        size_t nodePos = line.find("changed to node ");
-        if (nodePos != std::string::npos) {
-            size_t startPos = nodePos + 16;
-            if (startPos < line.length()) {
-                animationName = line.substr(startPos);
-            }
-        }
-    } else if (line.find("[info]") != std::string::npos &&
-               line.find("[OStimMenu.h:48] UI_TransitionRequest") != std::string::npos) {
-        size_t lastOpenBrace = line.rfind('{');
-        size_t lastCloseBrace = line.rfind('}');
-        if (lastOpenBrace != std::string::npos && lastCloseBrace != std::string::npos &&
-            lastCloseBrace > lastOpenBrace) {
-            animationName = line.substr(lastOpenBrace + 1, lastCloseBrace - lastOpenBrace - 1);
-        }
-    }
+void DumpLatencyStats(const std::string& reason) {
+    auto logsFolder = SKSE::log::log_directory();
+    if (!logsFolder) {
+        return;
+    }
+
+    try {
+        std::ofstream report(*logsFolder / "ORisk-and-Reward-NG-Latency.log", std::ios::trunc);
+        if (!report.is_open()) {
+            return;
+        }
+
+        report << "ORisk-and-Reward-NG latency report (" << reason << ") - " << GetCurrentTimeString() << "\n";
+        report << "All values in microseconds unless noted; percentiles are bucket upper bounds (~6% precision)\n\n";
+
+        report << "[OStim.log scrape lag (ms)]\n";
+        report << g_logScrapeLagHistogram.Summary() << "\n\n";
+
+        for (size_t source = 0; source < kLatencySourceCount; source++) {
+            bool hasSamples = false;
+            for (const auto& histogram : g_latencyHistograms[source]) {
+                if (histogram.count.load(std::memory_order_relaxed) > 0) {
+                    hasSamples = true;
+                    break;
+                }
+            }
+            if (!hasSamples) {
+                continue;
+            }
+
+            report << "[" << GetLatencySourceName(source) << "]\n";
+            for (size_t interval = 0; interval < static_cast<size_t>(LatencyInterval::Count); interval++) {
+                report << GetLatencyIntervalName(static_cast<LatencyInterval>(interval)) << ": "
+                       << g_latencyHistograms[source][interval].Summary() << "\n";
+            }
+            report << "\n";
+        }
+    } catch (...) {
+    }
+}
+
+std::shared_ptr<const SceneSnapshot> GetSceneSnapshot() {
+    static const auto emptySnapshot = std::make_shared<const SceneSnapshot>();
+    auto snapshot = g_sceneSnapshot.load(std::memory_order_acquire);
+    return snapshot ? snapshot : emptySnapshot;
+}
+
+void PublishSceneSnapshot() {
+    auto snapshot = std::make_shared<SceneSnapshot>();
+    snapshot->version = ++g_sceneSnapshotVersion;
+    snapshot->inScene = g_inOStimScene;
+    snapshot->state = g_sceneState;
+    snapshot->lastAnimation = g_lastAnimation;
+    snapshot->animationInfo = g_currentAnimationInfo;
+    snapshot->actors = g_sceneActors;
+    snapshot->tags = g_sceneTagStats.tags;
+    snapshot->speed = g_sceneTagStats.speed;
+    snapshot->sceneStartTime = g_sceneStartTime;
+    g_sceneSnapshot.store(std::move(snapshot), std::memory_order_release);
+}
+
+void RunSceneStrandTask(const std::function<void()>& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        logger::error("Error running scene strand task: {}", e.what());
+    } catch (...) {
+        logger::error("Unknown error running scene strand task");
+    }
+}
+
+size_t DrainSceneStrandTasks() {
+    std::deque<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(g_sceneStrandMutex);
+        tasks.swap(g_sceneStrandTasks);
+    }
+
+    for (const auto& task : tasks) {
+        RunSceneStrandTask(task);
+    }
+    return tasks.size();
+}
+
+void PostToSceneStrand(std::function<void()> task) {
+    if (t_sceneStrand) {
+        RunSceneStrandTask(task);
+        return;
+    }
+
+    if (!g_eventWorkerActive.load()) {
+        t_sceneStrand = true;
+        RunSceneStrandTask(task);
+        t_sceneStrand = false;
+        PublishSceneSnapshot();
+        return;
+    }
+
+    EnqueueSceneStrandTask(std::move(task));
+}
+
+// Like PostToSceneStrand, but never runs inline on the strand: the task goes behind everything
+// already queued, so the state the caller leaves behind is published first.
+void EnqueueSceneStrandTask(std::function<void()> task) {
+    if (!g_eventWorkerActive.load()) {
+        PostToSceneStrand(std::move(task));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_sceneStrandMutex);
+        g_sceneStrandTasks.push_back(std::move(task));
+    }
+    g_eventQueueSignal.fetch_add(1, std::memory_order_release);
+    g_eventQueueSignal.notify_one();
+}
+
+// Blocks until the task has run. Only for background threads that need a result; the game thread
+// posts and moves on.
+void RunOnSceneStrand(std::function<void()> task) {
+    if (t_sceneStrand || !g_eventWorkerActive.load()) {
+        PostToSceneStrand(std::move(task));
+        return;
+    }
+
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> finished = done->get_future();
+    PostToSceneStrand([task = std::move(task), done]() {
+        RunSceneStrandTask(task);
+        done->set_value();
+    });
+    finished.wait();
+}
+
+void EventWorkerThreadFunction() {
+    WriteToOStimEventsLog("Mod event worker thread started", __LINE__);
+
+    t_sceneStrand = true;
+    ParsedModEvent event;
+    while (true) {
+        uint32_t observedSignal = g_eventQueueSignal.load(std::memory_order_acquire);
+
+        size_t processed = 0;
+        while (g_modEventQueue.TryDequeue(event)) {
+            try {
+                OStimModEventSink::GetSingleton().ProcessQueuedEvent(event);
+            } catch (const std::exception& e) {
+                logger::error("Error processing queued OStim event: {}", e.what());
+            } catch (...) {
+                logger::error("Unknown error processing queued OStim event");
+            }
+            processed++;
+        }
+
+        processed += DrainSceneStrandTasks();
+        if (processed > 0) {
+            PublishSceneSnapshot();
+        }
+
+        if (!g_eventWorkerActive.load()) {
+            break;
+        }
+
+        g_eventQueueSignal.wait(observedSignal, std::memory_order_acquire);
+    }
+
+    WriteToOStimEventsLog("Mod event worker thread stopped", __LINE__);
+}
+
+void StartEventWorker() {
+    if (!g_eventWorkerActive) {
+        g_eventWorkerActive = true;
+        g_eventWorkerThread = std::thread(EventWorkerThreadFunction);
+    }
+}
+
+void StopEventWorker() {
+    if (g_eventWorkerActive) {
+        g_eventWorkerActive = false;
+        g_eventQueueSignal.fetch_add(1, std::memory_order_release);
+        g_eventQueueSignal.notify_one();
+        if (g_eventWorkerThread.joinable()) {
+            g_eventWorkerThread.join();
+        }
+
+        t_sceneStrand = true;
+        DrainSceneStrandTasks();
+        t_sceneStrand = false;
+        PublishSceneSnapshot();
+    }
+}
+
+class GameEventProcessor : public RE::BSTEventSink<RE::MenuOpenCloseEvent>,
+                           public RE::BSTEventSink<RE::TESSwitchRaceCompleteEvent> {
+    GameEventProcessor() = default;
+    ~GameEventProcessor() = default;
+    GameEventProcessor(const GameEventProcessor&) = delete;
+    GameEventProcessor(GameEventProcessor&&) = delete;
+    GameEventProcessor& operator=(const GameEventProcessor&) = delete;
+    GameEventProcessor& operator=(GameEventProcessor&&) = delete;
+
+public:
+    static GameEventProcessor& GetSingleton() {
+        static GameEventProcessor singleton;
+        return singleton;
+    }
+
+    RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* event,
+                                          RE::BSTEventSource<RE::MenuOpenCloseEvent>*) override {
+        if (event) {
+            std::stringstream msg;
+            msg << "Menu " << event->menuName.c_str() << " " << (event->opening ? "opened" : "closed");
+            WriteToActionsLog(msg.str(), __LINE__);
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    RE::BSEventNotifyControl ProcessEvent(const RE::TESSwitchRaceCompleteEvent* event,
+                                          RE::BSTEventSource<RE::TESSwitchRaceCompleteEvent>*) override {
+        if (event && event->subject) {
+            RE::FormID refID = event->subject->GetFormID();
+            g_actorClassCache.Invalidate(refID);
+            g_actorIdentityCache.Forget(refID);
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+};
+
+int GetEventThreadID(const QueuedModEvent& event) {
+    switch (event.type) {
+        case OStimEventType::ThreadStart:
+        case OStimEventType::ThreadSceneChanged:
+        case OStimEventType::ThreadSpeedChanged:
+        case OStimEventType::ThreadEnd:
+        case OStimEventType::ActorOrgasm:
+            return static_cast<int>(event.numArg);
+        default:
+            return 0;
+    }
+}
+
+std::shared_ptr<OStimThreadState> GetOrCreateThreadState(int threadID) {
+    std::lock_guard<std::mutex> lock(g_threadStatesMutex);
+    auto& state = g_threadStates[threadID];
+    if (!state) {
+        state = std::make_shared<OStimThreadState>();
+        state->threadID = threadID;
+        state->startTime = std::chrono::steady_clock::now();
+        state->lastChangeTime = state->startTime;
+
+        WriteToOStimEventsLog("========================================", __LINE__);
+        WriteToOStimEventsLog("NPC OSTIM THREAD STARTED", __LINE__);
+        WriteToOStimEventsLog("Thread ID: " + std::to_string(threadID), __LINE__);
+        WriteToOStimEventsLog("Concurrent OStim threads: " + std::to_string(g_threadStates.size()), __LINE__);
+        WriteToOStimEventsLog("========================================", __LINE__);
+    }
+    return state;
+}
+
+void UpdateThreadAnimation(int threadID, const std::string& animationName, const std::string& source) {
+    if (animationName.empty()) {
+        return;
+    }
+
+    auto state = GetOrCreateThreadState(threadID);
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    if (state->animationInfo.animationName == animationName) {
+        return;
+    }
+
+    SceneAnalysis analysis = GetSceneAnalysis(animationName);
+    state->animationInfo.animationName = animationName;
+    state->animationInfo.implicitTags = analysis.tags;
+    state->animationInfo.position = analysis.position;
+    state->animationInfo.intensity = analysis.intensity;
+    state->animationInfo.detectedTime = std::chrono::steady_clock::now();
+    state->speed = 0;
+    state->animationChanges++;
+    state->lastChangeTime = state->animationInfo.detectedTime;
+
+    std::string tagsStr = FormatTagSet(state->animationInfo.implicitTags);
+
+    WriteToOStimEventsLog("[Thread " + std::to_string(threadID) + "] Animation (" + source + "): " + animationName +
+                              (tagsStr.empty() ? "" : " | Tags: " + tagsStr),
+                          __LINE__);
+}
+
+void UpdateThreadSpeed(int threadID, int speed) {
+    auto state = GetOrCreateThreadState(threadID);
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    if (state->speed != speed) {
+        state->speed = speed;
+        WriteToOStimEventsLog("[Thread " + std::to_string(threadID) + "] Speed: " + std::to_string(speed), __LINE__);
+    }
+}
+
+void AddThreadActor(int threadID, RE::Actor* actor) {
+    if (!actor) {
+        return;
+    }
+
+    auto state = GetOrCreateThreadState(threadID);
+    std::lock_guard<std::mutex> lock(state->mutex);
+
+    RE::FormID refID = actor->GetFormID();
+    for (const auto& existing : state->actors) {
+        if (existing.refID == refID) {
+            return;
+        }
+    }
+
+    ActorInfo info = CaptureActorInfo(actor);
+    if (info.captured) {
+        state->actors.push_back(info);
+        WriteToOStimEventsLog("[Thread " + std::to_string(threadID) + "] Actor joined: " + info.name, __LINE__);
+    }
+}
+
+void RecordThreadOrgasm(int threadID, RE::Actor* actor) {
+    AddThreadActor(threadID, actor);
+
+    auto state = GetOrCreateThreadState(threadID);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->orgasmCount++;
+
+    std::string actorName = "Unknown";
+    if (actor && actor->GetActorBase()) {
+        actorName = actor->GetActorBase()->GetName();
+    }
+    WriteToOStimEventsLog("[Thread " + std::to_string(threadID) + "] Orgasm: " + actorName +
+                              " (player reward and spell systems not applied to NPC threads)",
+                          __LINE__);
+}
+
+void EndThreadState(int threadID, const std::string& source) {
+    std::shared_ptr<OStimThreadState> state;
+    size_t remaining = 0;
+    {
+        std::lock_guard<std::mutex> lock(g_threadStatesMutex);
+        auto it = g_threadStates.find(threadID);
+        if (it == g_threadStates.end()) {
+            return;
+        }
+        state = it->second;
+        g_threadStates.erase(it);
+        remaining = g_threadStates.size();
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    auto durationSeconds = std::chrono::duration_cast<std::chrono::seconds>(
+                               std::chrono::steady_clock::now() - state->startTime)
+                               .count();
+
+    WriteToOStimEventsLog("========================================", __LINE__);
+    WriteToOStimEventsLog("NPC OSTIM THREAD ENDED (" + source + ")", __LINE__);
+    WriteToOStimEventsLog("Thread ID: " + std::to_string(threadID), __LINE__);
+    WriteToOStimEventsLog("Duration: " + std::to_string(durationSeconds) + "s", __LINE__);
+    WriteToOStimEventsLog("Animation changes: " + std::to_string(state->animationChanges), __LINE__);
+    WriteToOStimEventsLog("Orgasms: " + std::to_string(state->orgasmCount), __LINE__);
+    for (const auto& actor : state->actors) {
+        WriteToOStimEventsLog("Actor: " + actor.name + " (RefID: 0x" + std::to_string(actor.refID) + ")", __LINE__);
+    }
+    WriteToOStimEventsLog("Remaining NPC threads: " + std::to_string(remaining), __LINE__);
+    WriteToOStimEventsLog("========================================", __LINE__);
+}
+
+void ClearAllThreadStates() {
+    std::lock_guard<std::mutex> lock(g_threadStatesMutex);
+    g_threadStates.clear();
+}
+
+void ProcessNPCThreadLine(const std::string& line, int threadID) {
+    if (IsSceneEndMarker(line)) {
+        EndThreadState(threadID, "OStim.log");
+        return;
+    }
+
+    size_t nodePos = line.find("changed to node ");
+    if (nodePos != std::string::npos) {
+        std::string animationName = line.substr(nodePos + 16);
+        animationName.erase(animationName.find_last_not_of(" \n\r\t") + 1);
+        UpdateThreadAnimation(threadID, animationName, "OStim.log");
+        return;
+    }
+
+    size_t speedPos = line.find("changed speed to ");
+    if (speedPos != std::string::npos) {
+        try {
+            UpdateThreadSpeed(threadID, std::stoi(line.substr(speedPos + 17)));
+        } catch (...) {
+        }
+    }
+}
+
+const char* GetSceneInputSourceName(SceneInputSource source) {
+    switch (source) {
+        case SceneInputSource::OStimLog: return "OStim.log";
+        case SceneInputSource::ModEvent: return "Mod Event";
+        case SceneInputSource::Monitor: return "Monitor";
+    }
+    return "Unknown";
+}
+
+void ResolveSceneCaches() {
+    LoadConfiguration();
+    CheckVampireTearsPluginAvailability();
+    ResolveItemFormIDs();
+    
+    if (!g_cachedSpellFormIDs.resolved) {
+        InitializeSpellCache();
+    }
+    if (!g_cachedFactionIDs.resolved) {
+        InitializeFactionCache();
+    }
+}
+
+SceneWarmup PrepareSceneWarmup() {
+    auto start = std::chrono::steady_clock::now();
+    SceneWarmup warmup;
+    
+    RefreshSceneIndex("scene warm-up");
+    
+    warmup.elapsed = std::chrono::steady_clock::now() - start;
+    return warmup;
+}
+
+void StartSceneWarmup() {
+    DiscardSceneWarmup();
+    ResolveSceneCaches();
+    g_actorClassCache.Clear();
+    if (t_replayThread) {
+        return;
+    }
+    
+    RequestWorldSnapshot();
+    try {
+        g_sceneWarmupFuture = std::async(std::launch::async, []() {
+            SceneWarmup warmup = PrepareSceneWarmup();
+            warmup.preparedAtPrestart = true;
+            return warmup;
+        });
+        WriteToOStimEventsLog("Scene warm-up started (prestart)", __LINE__);
+    } catch (...) {
+        WriteToOStimEventsLog("WARNING: Could not start async scene warm-up - will prepare at scene start", __LINE__);
+    }
+}
+
+SceneWarmup TakeSceneWarmup() {
+    if (g_sceneWarmupFuture.valid()) {
+        try {
+            return g_sceneWarmupFuture.get();
+        } catch (...) {
+            WriteToOStimEventsLog("WARNING: Prestart warm-up failed - preparing scene inline", __LINE__);
+        }
+    }
+    ResolveSceneCaches();
+    return PrepareSceneWarmup();
+}
+
+void DiscardSceneWarmup() {
+    if (g_sceneWarmupFuture.valid()) {
+        try {
+            g_sceneWarmupFuture.get();
+        } catch (...) {
+        }
+    }
+}
+
+void RunSceneStartActions(const SceneInput& input) {
+    g_actorClassCache.Clear();
+    if (!t_replayThread) {
+        RequestWorldSnapshot();
+    }
+    SceneWarmup warmup = TakeSceneWarmup();
+    
+    g_sceneActors.reserve(kSceneActorReserve);
+    ActorInfo playerInfo = CapturePlayerInfo();
+    if (playerInfo.captured) {
+        g_sceneActors.Insert(playerInfo, 0.0f);
+    }
+    g_scenePlayerPending = !playerInfo.captured && !t_replayThread;
+    
+    if (!g_sceneActors.empty()) {
+        CleanupTagBasedEffectsAtSceneStart(g_sceneActors.Actors());
+    }
+    
+    g_sceneTagStats.Reset(input.timestamp);
+    
+    SetInOStimScene(true);
+    
+    WriteToOStimEventsLog("========================================", __LINE__);
+    WriteToOStimEventsLog("SCENE START EVENT", __LINE__);
+    WriteToOStimEventsLog("New OStim scene started", __LINE__);
+    WriteToOStimEventsLog("Starting animation: " + input.animationName, __LINE__);
+    WriteToOStimEventsLog("Initializing event monitoring systems", __LINE__);
+    WriteToOStimEventsLog("========================================", __LINE__);
+    
+    WriteToOStimEventsLog("Scene warm-up " + std::string(warmup.preparedAtPrestart ? "prepared at prestart" : "prepared inline") +
+                              " in " + std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(warmup.elapsed).count()) + " us",
+                          __LINE__);
+    
+    RecordReplayDecision("SCENE_START", input.animationName);
+    
+    g_lastGoldRewardTime = std::chrono::steady_clock::now();
+    g_goldRewardActive = true;
+    g_lastItem1RewardTime = std::chrono::steady_clock::now();
+    g_item1RewardActive = true;
+    g_lastItem2RewardTime = std::chrono::steady_clock::now();
+    g_item2RewardActive = true;
+    g_lastMilkRewardTime = std::chrono::steady_clock::now();
+    g_milkRewardActive = true;
+    g_lastMilkWenchRewardTime = std::chrono::steady_clock::now();
+    g_milkWenchRewardActive = true;
+    g_lastMilkEthelRewardTime = std::chrono::steady_clock::now();
+    g_milkEthelRewardActive = true;
+    g_lastAttributesRestorationTime = std::chrono::steady_clock::now();
+    g_attributesRestorationActive = true;
+    g_lastNPCDetectionCheck = std::chrono::steady_clock::now();
+    g_wenchMilkNPCDetected = false;
+    g_ethelNPCDetected = false;
+
+    WriteToActionsLog("OStim scene started - all reward systems activated", __LINE__);
+}
+
+void RunSceneEndActions(const SceneInput& input) {
+    WriteToOStimEventsLog("========================================", __LINE__);
+    WriteToOStimEventsLog("SCENE END EVENT DETECTED", __LINE__);
+    WriteToOStimEventsLog("Source: " + std::string(GetSceneInputSourceName(input.source)), __LINE__);
+    WriteToOStimEventsLog("Actors in scene: " + std::to_string(g_sceneActors.size()), __LINE__);
+    
+    RecordReplayDecision("SCENE_END", GetLastAnimation());
+    
+    std::vector<ActorInfo> sceneActorsCopy = g_sceneActors.Actors();
+    for (const auto& actor : sceneActorsCopy) {
+        g_actorIdentityCache.Remember(actor);
+    }
+
+    for (const auto& actor : sceneActorsCopy) {
+        WriteToOStimEventsLog("Actor to verify: " + actor.name + " (RefID: 0x" + 
+            std::to_string(actor.refID) + ")", __LINE__);
+    }
+    
+    g_sceneEndTime = input.timestamp;
+    
+    WriteToOStimEventsLog("Cleanup scheduled with 1-second delay to avoid OStim collision", __LINE__);
+    
+    GenerateTagsReport();
+    g_sceneTagStats.Reset(input.timestamp);
+    g_currentAnimationInfo = AnimationTagInfo{};
+    
+    SetInOStimScene(false);
+    
+    g_goldRewardActive = false;
+    g_item1RewardActive = false;
+    g_item2RewardActive = false;
+    g_milkRewardActive = false;
+    g_milkWenchRewardActive = false;
+    g_milkEthelRewardActive = false;
+    g_attributesRestorationActive = false;
+    
+    g_detectedNPCNames.clear();
+    g_npcNameToRefID.clear();
+    
+    g_lastOrgasmTimestamps.clear();
+    
+    ClearOrgasmCounters();
+    ClearBloodyNoseCounters();
+    
+    if (!g_pendingSpellCasts.empty()) {
+        WriteToOStimEventsLog("Clearing " + std::to_string(g_pendingSpellCasts.size()) + 
+                             " pending spell casts (scene ended)", __LINE__);
+        g_pendingSpellCasts.clear();
+    }
+    
+    g_sceneActors.clear();
+    g_scenePlayerPending = false;
+    g_lastProcessedAnimationForTags = "";
+    g_worldSnapshot.store(nullptr, std::memory_order_release);
+    
+    WriteToOStimEventsLog("OStim scene ended - all event data cleared", __LINE__);
+    WriteToOStimEventsLog("g_sceneActors cleared", __LINE__);
+    WriteToOStimEventsLog("========================================", __LINE__);
+    
+    WriteToActionsLog("OStim scene ended - all reward systems stopped and spell effects deactivated", __LINE__);
+    
+    DumpEventQueueStats("scene end");
+    DumpLatencyStats("scene end");
+}
+
+void RunSceneCleanupActions() {
+    WriteToOStimEventsLog("========================================", __LINE__);
+    WriteToOStimEventsLog("EXECUTING DELAYED CLEANUP (1 second after OStim end)", __LINE__);
+    WriteToOStimEventsLog("========================================", __LINE__);
+    
+    if (t_replayThread) {
+        RecordReplayDecision("CLEANUP", "scene end");
+        WriteToOStimEventsLog("Replay mode - delayed cleanup skipped", __LINE__);
+        return;
+    }
+    
+    CleanupSpellEffectsFromLog();
+    CleanupSpellEffectsByFaction();
+    DeactivateAllSpellEffects();
+    
+    WriteToOStimEventsLog("Delayed cleanup completed successfully", __LINE__);
+}
+
+// Thread events can add actors before the log shows the scene starting; if the thread ends first,
+// nothing else would clear them before the next scene.
+void ClearUnstartedSceneActors() {
+    if (g_sceneActors.empty() && g_detectedNPCNames.empty()) {
+        return;
+    }
+    WriteToOStimEventsLog("Clearing " + std::to_string(g_sceneActors.size()) + " actors from a scene that never started", __LINE__);
+    g_sceneActors.clear();
+    g_scenePlayerPending = false;
+    g_detectedNPCNames.clear();
+    g_npcNameToRefID.clear();
+}
+
+SceneState ApplySceneInput(const SceneInput& input) {
+    SceneState previousState = g_sceneState;
+    SceneTransition transition = EvaluateSceneTransition(previousState, input.kind);
+    
+    if (transition.actions & kSceneActionDeferInput) {
+        WriteToOStimEventsLog("Scene input deferred until cleanup: " + std::string(GetSceneInputName(input.kind)) +
+                                  " from " + GetSceneInputSourceName(input.source),
+                              __LINE__);
+        g_deferredSceneInput = input;
+        return previousState;
+    }
+    if (input.kind == SceneInputKind::Prestart || input.kind == SceneInputKind::SceneStart) {
+        g_deferredSceneInput.reset();
+    }
+    if (input.kind == SceneInputKind::End && (previousState == SceneState::Idle || previousState == SceneState::Prestart)) {
+        ClearUnstartedSceneActors();
+    }
+    
+    if (transition.next == previousState && transition.actions == kSceneActionNone) {
+        if (input.kind != SceneInputKind::SceneStart || previousState != SceneState::Active) {
+            WriteToOStimEventsLog("Scene input absorbed: " + std::string(GetSceneInputName(input.kind)) + " from " +
+                                      GetSceneInputSourceName(input.source) + " in state " +
+                                      GetSceneStateName(previousState),
+                                  __LINE__);
+        }
+        return previousState;
+    }
+    
+    WriteToOStimEventsLog("Scene state: " + std::string(GetSceneStateName(previousState)) + " -> " +
+                              GetSceneStateName(transition.next) + " (" + GetSceneInputName(input.kind) + " from " +
+                              GetSceneInputSourceName(input.source) + ")",
+                          __LINE__);
+    
+    if (transition.actions & kSceneActionRunCleanup) {
+        RunSceneCleanupActions();
+    }
+    if (transition.actions & kSceneActionClearCache) {
+        DiscardSceneWarmup();
+        ClearNPCsCache();
+    }
+    if ((transition.actions & kSceneActionBuildCache) && !(transition.actions & kSceneActionStartScene)) {
+        StartSceneWarmup();
+    }
+    if (transition.actions & kSceneActionStartScene) {
+        RunSceneStartActions(input);
+    }
+    if (transition.actions & kSceneActionEndScene) {
+        RunSceneEndActions(input);
+    }
+    
+    g_sceneState = transition.next;
+    
+    if (g_sceneState == SceneState::CleanupPending) {
+        // A replay's deferred scene start must stay a replay decision when CleanupDone releases it.
+        EnqueueSceneStrandTask([replay = t_replayThread]() {
+            bool wasReplay = std::exchange(t_replayThread, replay);
+            ApplySceneInput({SceneInputKind::CleanupDone, SceneInputSource::Monitor, std::chrono::steady_clock::now(), ""});
+            t_replayThread = wasReplay;
+        });
+    } else if (g_sceneState == SceneState::Idle && g_deferredSceneInput) {
+        SceneInput deferred = std::move(*g_deferredSceneInput);
+        g_deferredSceneInput.reset();
+        ApplySceneInput(deferred);
+    }
+    
+    return previousState;
+}
+
+SceneState GetSceneState() {
+    return g_sceneState;
+}
+
+void ResetSceneStateMachine() {
+    DiscardSceneWarmup();
+    g_deferredSceneInput.reset();
+    g_sceneState = SceneState::Idle;
+}
+
+bool DetectSceneEnd(const std::string& line) {
+    if (line.find("[Thread.cpp:634] closing thread") != std::string::npos) {
+        WriteToAnimationsLog("DETECTED: OStim thread closing", __LINE__);
+        return true;
+    }
+    if (line.find("[ThreadManager.cpp:174] trying to stop thread") != std::string::npos) {
+        WriteToAnimationsLog("DETECTED: OStim trying to stop thread", __LINE__);
+        return true;
+    }
+    return false;
+}
+
+void ProcessNewLine(const std::string& line, const std::string& hashStr) {
+    if (line.find("[warning]") != std::string::npos) {
+        return;
+    }
+
+    if (g_processedLines.find(hashStr) != g_processedLines.end()) {
+        return;
+    }
+
+    int lineThreadID = ParseThreadIDFromLine(line);
+    if (lineThreadID > 0) {
+        ProcessNPCThreadLine(line, lineThreadID);
+        return;
+    }
+
+    std::string animationName(DetectAnimationChange(line));
+    
+    DetectNPCNamesFromLine(line);
+    
+    ParseOStimEventFromLine(line);
+
+    if (DetectSceneEnd(line)) {
+        g_processedLines.insert(hashStr);
+        ApplySceneInput({SceneInputKind::End, SceneInputSource::OStimLog, std::chrono::steady_clock::now(), ""});
+        WriteToAnimationsLog("OStim scene ended", __LINE__);
+        return;
+    }
+
+    if (!animationName.empty()) {
+        g_processedLines.insert(hashStr);
+
+        if (animationName == GetLastAnimation()) {
+            return;
+        }
+
+        SetLastAnimation(animationName);
+        RecordReplayDecision("ANIMATION", animationName);
+        AnalyzeAnimationForTags(animationName);
+        
+        SceneState previousState = ApplySceneInput(
+            {SceneInputKind::SceneStart, SceneInputSource::OStimLog, std::chrono::steady_clock::now(), animationName});
+        
+        if (previousState == SceneState::Active) {
+            RemoveTagBasedSpellEffects();
+            CheckAnimationTagsForSpellSystems(animationName);
+        }
+
+        if (g_processedLines.size() > 500) {
+            g_processedLines.clear();
+        }
+
+        std::string formattedAnimation = "{" + animationName + "}";
+        WriteToAnimationsLog(formattedAnimation, __LINE__);
+    }
+}
+
+void InitializeNewlineSearch() {
+    if (g_findNextNewline) {
+        return;
+    }
+
+    if (IsAVX2Supported()) {
+        g_findNextNewline = FindNextNewlineAVX2;
+        WriteToAnimationsLog("OStim.log line splitter: AVX2", __LINE__);
+    } else {
+        g_findNextNewline = FindNextNewlineSSE2;
+        WriteToAnimationsLog("OStim.log line splitter: SSE2", __LINE__);
+    }
+}
+
+bool ProcessOStimLogLine(std::string_view lineView, std::string& lineBuffer) {
+    if (!LineMayContainMarker(lineView)) {
+        return false;
+    }
+
+    lineBuffer.assign(lineView);
+    size_t lineHash = std::hash<std::string>{}(lineBuffer);
+
+    if (t_replayThread) {
+        ProcessNewLine(lineBuffer, std::to_string(lineHash));
+        return true;
+    }
+
+    if (!g_catchUpComplete) {
+        PostToSceneStrand([line = lineBuffer, hashStr = std::to_string(lineHash)]() { ProcessNewLine(line, hashStr); });
+        return true;
+    }
+
+    LatencyTrace trace;
+    trace.source = kLatencySourceOStimLog;
+    auto now = std::chrono::steady_clock::now();
+    trace.Mark(LatencyStage::Received, now);
+
+    long long lineMs = 0;
+    if (ParseLogLineTimeOfDayMs(lineView, lineMs)) {
+        long long lagMs = GetLocalTimeOfDayMs() - lineMs;
+        if (lagMs < 0) {
+            lagMs += 24LL * 60 * 60 * 1000;
+        }
+        if (lagMs < 60LL * 60 * 1000) {
+            g_logScrapeLagHistogram.Record(static_cast<uint64_t>(lagMs));
+            trace.Mark(LatencyStage::Received, now - std::chrono::milliseconds(lagMs));
+        }
+    }
+
+    PostToSceneStrand([line = lineBuffer, hashStr = std::to_string(lineHash), trace]() mutable {
+        trace.Mark(LatencyStage::Dequeued);
+        RecordLatencyInterval(trace.source, LatencyInterval::QueueWait, trace, LatencyStage::Received,
+                              LatencyStage::Dequeued);
+
+        t_latencyTrace = &trace;
+        ProcessNewLine(line, hashStr);
+        t_latencyTrace = nullptr;
+    });
+    return true;
+}
+
+LogChunkStats ProcessOStimLogChunk(const char* data, size_t length) {
+    LogChunkStats stats;
+    InitializeNewlineSearch();
+
+    std::string line;
+    stats.bytesConsumed = SplitLogLines(data, length, g_findNextNewline, [&](std::string_view lineView) {
+        stats.linesSeen++;
+        if (ProcessOStimLogLine(lineView, line)) {
+            stats.linesProcessed++;
+        }
+    });
+    return stats;
+}
+
+bool CatchUpOStimLog(const fs::path& logPath) {
+    HANDLE hFile = CreateFileW(logPath.wstring().c_str(), GENERIC_READ,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                               FILE_ATTRIBUTE_NORMAL, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    if (fileSize.QuadPart == 0) {
+        CloseHandle(hFile);
+        g_lastOStimLogPosition = 0;
+        g_lastFileSize = 0;
+        return true;
+    }
+
+    HANDLE hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!hMapping) {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    const char* view = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (!view) {
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    size_t length = static_cast<size_t>(fileSize.QuadPart);
+    size_t scannedLines = 0;
+    size_t replayedLines = 0;
+    bool sceneEndFound = false;
+
+    try {
+        const char* lastNewline = FindPreviousNewline(view, view + length);
+        const char* dataEnd = lastNewline ? lastNewline + 1 : view;
+        const char* sceneBegin = view;
+        const char* lineEnd = dataEnd;
+
+        while (lineEnd > view) {
+            const char* previousNewline = FindPreviousNewline(view, lineEnd - 1);
+            const char* lineStart = previousNewline ? previousNewline + 1 : view;
+            scannedLines++;
+
+            std::string_view scannedLine(lineStart, lineEnd - 1 - lineStart);
+            if (IsSceneEndMarker(scannedLine) && ParseThreadIDFromLine(scannedLine) <= 0) {
+                sceneBegin = lineEnd;
+                sceneEndFound = true;
+                break;
+            }
+            lineEnd = lineStart;
+        }
+
+        LogChunkStats replayStats = ProcessOStimLogChunk(sceneBegin, dataEnd - sceneBegin);
+        replayedLines = replayStats.linesProcessed;
+
+        g_lastOStimLogPosition = static_cast<std::streamoff>(dataEnd - view);
+        g_lastFileSize = length;
+    } catch (...) {
+        UnmapViewOfFile(view);
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        throw;
+    }
+
+    UnmapViewOfFile(view);
+    CloseHandle(hMapping);
+    CloseHandle(hFile);
+
+    auto elapsedMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+    WriteToAnimationsLog("========================================", __LINE__);
+    WriteToAnimationsLog("OStim.log CATCH-UP COMPLETE", __LINE__);
+    WriteToAnimationsLog("File size: " + std::to_string(length) + " bytes", __LINE__);
+    WriteToAnimationsLog("Lines scanned backwards: " + std::to_string(scannedLines), __LINE__);
+    WriteToAnimationsLog(sceneEndFound ? "Last scene end marker found - skipping previous scenes"
+                                       : "No scene end marker found - replaying whole file",
+                         __LINE__);
+    WriteToAnimationsLog("Lines replayed for current scene: " + std::to_string(replayedLines), __LINE__);
+    WriteToAnimationsLog("Catch-up time: " + std::to_string(elapsedMs) + " ms", __LINE__);
+    WriteToAnimationsLog("========================================", __LINE__);
+
+    return true;
+}
+
+uint64_t HashSceneID(std::string_view sceneID) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : sceneID) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash != 0 ? hash : 1;
+}
+
+uint64_t LookupSceneTagBit(std::string_view tag) {
+    struct TagMapping {
+        std::string_view name;
+        uint64_t bit;
+    };
+    static constexpr TagMapping mappings[] = {
+        {"standing", kSceneTagStanding},    {"sitting", kSceneTagSitting},
+        {"lying", kSceneTagLying},          {"laying", kSceneTagLying},
+        {"lyingback", kSceneTagLying},      {"doggystyle", kSceneTagDoggy},
+        {"doggy", kSceneTagDoggy},          {"frombehind", kSceneTagDoggy},
+        {"missionary", kSceneTagMissionary}, {"matingpress", kSceneTagMissionary | kSceneTagPressing},
+        {"oral", kSceneTagOral},            {"blowjob", kSceneTagOral},
+        {"cunnilingus", kSceneTagOral},     {"deepthroat", kSceneTagOral},
+        {"sixtynine", kSceneTagOral},       {"vaginal", kSceneTagVaginal},
+        {"vaginalsex", kSceneTagVaginal},   {"anal", kSceneTagAnal},
+        {"analsex", kSceneTagAnal},         {"kissing", kSceneTagKissing},
+        {"kiss", kSceneTagKissing},         {"touching", kSceneTagTouching},
+        {"caressing", kSceneTagTouching},   {"petting", kSceneTagTouching},
+        {"groping", kSceneTagTouching},     {"rough", kSceneTagRough},
+        {"gentle", kSceneTagGentle},        {"romantic", kSceneTagGentle},
+        {"sensual", kSceneTagGentle},       {"aggressive", kSceneTagAggressive},
+        {"dominant", kSceneTagAggressive},  {"intimate", kSceneTagIntimate},
+        {"cuddling", kSceneTagIntimate},    {"transition", kSceneTagTransition},
+        {"spread", kSceneTagSpread},        {"pressing", kSceneTagPressing},
+        {"oare", kSceneTagOARE}};
+
+    for (const auto& mapping : mappings) {
+        if (OStimJsonReader::KeyIs(tag, mapping.name)) {
+            return mapping.bit;
+        }
+    }
+    return 0;
+}
+
+uint8_t LookupSceneFurniture(std::string_view furniture) {
+    for (size_t i = 0; i < kSceneFurnitureNames.size() - 1; i++) {
+        if (OStimJsonReader::KeyIs(furniture, kSceneFurnitureNames[i])) {
+            return static_cast<uint8_t>(i);
+        }
+    }
+    return static_cast<uint8_t>(kSceneFurnitureNames.size() - 1);
+}
+
+bool ParseSceneDefinition(std::string_view json, SceneIndexEntry& entry) {
+    OStimJsonReader reader{json, 0};
+
+    auto readTagList = [&reader, &entry]() {
+        return reader.ForEachElement([&reader, &entry]() {
+            std::string_view tag;
+            if (reader.pos < reader.text.size() && reader.text[reader.pos] == '"') {
+                if (!reader.ReadString(tag)) {
+                    return false;
+                }
+                entry.tagBits |= LookupSceneTagBit(tag);
+                return true;
+            }
+            return reader.SkipValue();
+        });
+    };
+
+    return reader.ForEachMember([&](std::string_view key) {
+        if (OStimJsonReader::KeyIs(key, "tags")) {
+            return readTagList();
+        }
+        if (OStimJsonReader::KeyIs(key, "actors")) {
+            return reader.ForEachElement([&]() {
+                if (entry.actorCount < UINT8_MAX) {
+                    entry.actorCount++;
+                }
+                return reader.ForEachMember([&](std::string_view actorKey) {
+                    return OStimJsonReader::KeyIs(actorKey, "tags") ? readTagList() : reader.SkipValue();
+                });
+            });
+        }
+        if (OStimJsonReader::KeyIs(key, "actions")) {
+            return reader.ForEachElement([&]() {
+                return reader.ForEachMember([&](std::string_view actionKey) {
+                    if (OStimJsonReader::KeyIs(actionKey, "type") && reader.pos < reader.text.size() &&
+                        reader.text[reader.pos] == '"') {
+                        std::string_view type;
+                        if (!reader.ReadString(type)) {
+                            return false;
+                        }
+                        entry.tagBits |= LookupSceneTagBit(type);
+                        return true;
+                    }
+                    return reader.SkipValue();
+                });
+            });
+        }
+        if ((OStimJsonReader::KeyIs(key, "furniture") || OStimJsonReader::KeyIs(key, "furnituretype")) &&
+            reader.pos < reader.text.size() && reader.text[reader.pos] == '"') {
+            std::string_view furniture;
+            if (!reader.ReadString(furniture)) {
+                return false;
+            }
+            entry.furniture = LookupSceneFurniture(furniture);
+            return true;
+        }
+        if (OStimJsonReader::KeyIs(key, "destination") || OStimJsonReader::KeyIs(key, "transition")) {
+            entry.flags |= kSceneFlagTransition;
+            entry.tagBits |= kSceneTagTransition;
+        }
+        return reader.SkipValue();
+    });
+}
 
-    if (!animationName.empty()) {
-        animationName.erase(animationName.find_last_not_of(" \n\r\t") + 1);
+std::vector<uint8_t> SerializeSceneIndex(std::vector<SceneIndexEntry>& entries,
+                                         const std::vector<SceneIndexFileRecord>& files) {
+    std::sort(entries.begin(), entries.end(),
+              [](const SceneIndexEntry& a, const SceneIndexEntry& b) { return a.idHash < b.idHash; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const SceneIndexEntry& a, const SceneIndexEntry& b) { return a.idHash == b.idHash; }),
+                  entries.end());
+
+    uint32_t directoryBits = 4;
+    while (directoryBits < 20 && (size_t(1) << directoryBits) < entries.size()) {
+        directoryBits++;
+    }
+
+    size_t entriesOffset = SceneIndexView::EntriesOffset(directoryBits);
+    size_t filesOffset = entriesOffset + entries.size() * sizeof(SceneIndexEntry);
+    std::vector<uint8_t> buffer(filesOffset + files.size() * sizeof(SceneIndexFileRecord), 0);
+
+    SceneIndexHeader header{kSceneIndexMagic, kSceneIndexVersion, static_cast<uint32_t>(entries.size()),
+                            static_cast<uint32_t>(files.size()), directoryBits, 0};
+    memcpy(buffer.data(), &header, sizeof(header));
+
+    auto* directory = reinterpret_cast<uint32_t*>(buffer.data() + SceneIndexView::DirectoryOffset());
+    size_t bucketCount = size_t(1) << directoryBits;
+    size_t cursor = 0;
+    for (size_t bucket = 0; bucket <= bucketCount; bucket++) {
+        while (cursor < entries.size() && (entries[cursor].idHash >> (64 - directoryBits)) < bucket) {
+            cursor++;
+        }
+        directory[bucket] = static_cast<uint32_t>(cursor);
     }
+    directory[bucketCount] = static_cast<uint32_t>(entries.size());
 
-    return animationName;
+    if (!entries.empty()) {
+        memcpy(buffer.data() + entriesOffset, entries.data(), entries.size() * sizeof(SceneIndexEntry));
+    }
+    if (!files.empty()) {
+        memcpy(buffer.data() + filesOffset, files.data(), files.size() * sizeof(SceneIndexFileRecord));
+    }
+    return buffer;
 }
 
-void ProcessNewLine(const std::string& line, const std::string& hashStr) {
-    if (line.find("[warning]") != std::string::npos) {
-        return;
+std::shared_ptr<SceneIndexView> MapSceneIndexFile(const fs::path& indexPath) {
+    auto view = std::make_shared<SceneIndexView>();
+
+    view->file = CreateFileW(indexPath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (view->file == INVALID_HANDLE_VALUE) {
+        return nullptr;
     }
 
-    if (g_processedLines.find(hashStr) != g_processedLines.end()) {
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(view->file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(SceneIndexHeader))) {
+        return nullptr;
+    }
+
+    view->mapping = CreateFileMappingW(view->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!view->mapping) {
+        return nullptr;
+    }
+
+    view->mappedBase = static_cast<const uint8_t*>(MapViewOfFile(view->mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!view->mappedBase || !view->Bind(view->mappedBase, static_cast<size_t>(fileSize.QuadPart))) {
+        return nullptr;
+    }
+
+    return view;
+}
+
+std::shared_ptr<const SceneIndexView> GetSceneIndex() {
+    std::lock_guard<std::mutex> lock(g_sceneIndexMutex);
+    return g_sceneIndex;
+}
+
+void RefreshSceneIndex(const std::string& reason) {
+    std::unique_lock<std::mutex> buildLock(g_sceneIndexBuildMutex, std::try_to_lock);
+    if (!buildLock.owns_lock()) {
         return;
     }
 
-    std::string animationName = DetectAnimationChange(line);
-    
-    DetectNPCNamesFromLine(line);
-    
-    ParseOStimEventFromLine(line);
+    fs::path pluginDir = GetPluginINIPath();
+    fs::path scenesDir = pluginDir / "OStim" / "scenes";
+    fs::path indexPath = pluginDir / "ORisk-and-Reward-NG-SceneIndex.bin";
 
-    if (DetectSceneEnd(line)) {
-        g_processedLines.insert(hashStr);
-        if (IsInOStimScene()) {
-            WriteToOStimEventsLog("========================================", __LINE__);
-            WriteToOStimEventsLog("SCENE END EVENT DETECTED", __LINE__);
-            WriteToOStimEventsLog("Actors in scene: " + std::to_string(g_sceneActors.size()), __LINE__);
-            
-            std::vector<ActorInfo> sceneActorsCopy = g_sceneActors;
-            
-            for (const auto& actor : sceneActorsCopy) {
-                WriteToOStimEventsLog("Actor to verify: " + actor.name + " (RefID: 0x" + 
-                    std::to_string(actor.refID) + ")", __LINE__);
+    try {
+        auto startTime = std::chrono::steady_clock::now();
+
+        auto current = GetSceneIndex();
+        if (!current) {
+            auto mapped = MapSceneIndexFile(indexPath);
+            if (mapped) {
+                std::lock_guard<std::mutex> lock(g_sceneIndexMutex);
+                g_sceneIndex = mapped;
+                g_sceneIndexGeneration.fetch_add(1, std::memory_order_release);
+                current = mapped;
             }
-            
-            g_sceneEndTime = std::chrono::steady_clock::now();
-            g_cleanupPending = true;
-            
-            WriteToOStimEventsLog("Cleanup scheduled with 1-second delay to avoid OStim collision", __LINE__);
-            
-            g_currentOStimTags.clear();
-            g_currentOStimSpeed = 0;
-            g_currentAnimationInfo = AnimationTagInfo{};
-            
-            SetInOStimScene(false);
-            
-            g_goldRewardActive = false;
-            g_item1RewardActive = false;
-            g_item2RewardActive = false;
-            g_milkRewardActive = false;
-            g_milkWenchRewardActive = false;
-            g_milkEthelRewardActive = false;
-            g_attributesRestorationActive = false;
-            
-            g_detectedNPCNames.clear();
-            g_npcNameToRefID.clear();
-            
-            {
-                std::lock_guard<std::mutex> lock(g_orgasmMutex);
-                g_lastOrgasmTimestamps.clear();
+        }
+
+        std::error_code ec;
+        if (!fs::exists(scenesDir, ec)) {
+            WriteToAnimationsLog("Scene index: OStim scenes folder not found - using tag heuristics", __LINE__);
+            return;
+        }
+
+        // Walk the scenes folder only when it may have changed since the last walk. The change
+        // notification is re-armed before the walk, so edits made during it trigger the next one.
+        if (g_sceneIndexWatch == INVALID_HANDLE_VALUE) {
+            g_sceneIndexWatch = FindFirstChangeNotificationW(
+                scenesDir.wstring().c_str(), TRUE,
+                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_SIZE |
+                    FILE_NOTIFY_CHANGE_LAST_WRITE);
+        } else if (WaitForSingleObject(g_sceneIndexWatch, 0) == WAIT_OBJECT_0) {
+            FindNextChangeNotification(g_sceneIndexWatch);
+        } else if (current) {
+            return;
+        }
+
+        struct SceneFile {
+            fs::path path;
+            SceneIndexFileRecord record;
+        };
+        std::vector<SceneFile> sceneFiles;
+        for (auto it = fs::recursive_directory_iterator(scenesDir, fs::directory_options::skip_permission_denied, ec);
+             !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (!it->is_regular_file(ec) || it->path().extension() != ".json") {
+                continue;
             }
-            
-            ClearOrgasmCounters();
-            ClearBloodyNoseCounters();
-            
-            {
-                std::lock_guard<std::mutex> lock(g_pendingSpellMutex);
-                if (!g_pendingSpellCasts.empty()) {
-                    WriteToOStimEventsLog("Clearing " + std::to_string(g_pendingSpellCasts.size()) + 
-                                         " pending spell casts (scene ended)", __LINE__);
-                    g_pendingSpellCasts.clear();
+            SceneFile sceneFile;
+            sceneFile.path = it->path();
+            sceneFile.record.pathHash = HashSceneID(fs::relative(it->path(), scenesDir, ec).generic_string());
+            sceneFile.record.size = it->file_size(ec);
+            sceneFile.record.writeTime = it->last_write_time(ec).time_since_epoch().count();
+            sceneFile.record.idHash = HashSceneID(it->path().stem().string());
+            sceneFiles.push_back(std::move(sceneFile));
+        }
+
+        std::unordered_map<uint64_t, const SceneIndexFileRecord*> previousFiles;
+        if (current) {
+            previousFiles.reserve(current->header->fileCount);
+            for (uint32_t i = 0; i < current->header->fileCount; i++) {
+                previousFiles[current->files[i].pathHash] = &current->files[i];
+            }
+        }
+
+        std::vector<SceneIndexEntry> entries;
+        entries.reserve(sceneFiles.size());
+        std::vector<size_t> toParse;
+        size_t reused = 0;
+
+        for (size_t i = 0; i < sceneFiles.size(); i++) {
+            const auto& record = sceneFiles[i].record;
+            auto previous = previousFiles.find(record.pathHash);
+            if (previous != previousFiles.end() && previous->second->size == record.size &&
+                previous->second->writeTime == record.writeTime) {
+                if (const SceneIndexEntry* entry = current->Find(record.idHash)) {
+                    entries.push_back(*entry);
                 }
+                reused++;
+                continue;
             }
-            
-            g_sceneActors.clear();
-            g_lastProcessedAnimationForTags = "";
-            
-            WriteToOStimEventsLog("OStim scene ended - all event data cleared", __LINE__);
-            WriteToOStimEventsLog("g_sceneActors cleared", __LINE__);
-            WriteToOStimEventsLog("========================================", __LINE__);
-            
-            WriteToActionsLog("OStim scene ended - all reward systems stopped and spell effects deactivated", __LINE__);
+            toParse.push_back(i);
         }
-        WriteToAnimationsLog("OStim scene ended", __LINE__);
+
+        if (current && toParse.empty() && sceneFiles.size() == current->header->fileCount) {
+            return;
+        }
+
+        std::vector<SceneIndexEntry> parsed(toParse.size());
+        std::vector<uint8_t> parsedOk(toParse.size(), 0);
+        std::atomic<size_t> nextFile(0);
+        unsigned workerCount = std::max(1u, std::min(std::thread::hardware_concurrency(), 8u));
+        workerCount = static_cast<unsigned>(std::min<size_t>(workerCount, toParse.size() / 32 + 1));
+
+        auto parseWorker = [&]() {
+            std::string content;
+            for (size_t i = nextFile.fetch_add(1); i < toParse.size(); i = nextFile.fetch_add(1)) {
+                const auto& sceneFile = sceneFiles[toParse[i]];
+                std::ifstream file(sceneFile.path, std::ios::in | std::ios::binary);
+                if (!file.is_open()) {
+                    continue;
+                }
+                content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                SceneIndexEntry entry{};
+                entry.idHash = sceneFile.record.idHash;
+                if (ParseSceneDefinition(content, entry)) {
+                    parsed[i] = entry;
+                    parsedOk[i] = 1;
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned i = 1; i < workerCount; i++) {
+            workers.emplace_back(parseWorker);
+        }
+        parseWorker();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        size_t parseFailures = 0;
+        for (size_t i = 0; i < parsed.size(); i++) {
+            if (parsedOk[i]) {
+                entries.push_back(parsed[i]);
+            } else {
+                parseFailures++;
+            }
+        }
+
+        std::vector<SceneIndexFileRecord> records;
+        records.reserve(sceneFiles.size());
+        for (const auto& sceneFile : sceneFiles) {
+            records.push_back(sceneFile.record);
+        }
+
+        auto rebuilt = std::make_shared<SceneIndexView>();
+        rebuilt->owned = SerializeSceneIndex(entries, records);
+        if (!rebuilt->Bind(rebuilt->owned.data(), rebuilt->owned.size())) {
+            WriteToAnimationsLog("ERROR: Scene index serialization failed", __LINE__);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(g_sceneIndexMutex);
+            g_sceneIndex = rebuilt;
+            g_sceneIndexGeneration.fetch_add(1, std::memory_order_release);
+        }
+        current.reset();
+
+        fs::path tempPath = indexPath;
+        tempPath += ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char*>(rebuilt->owned.data()), rebuilt->owned.size());
+        }
+        if (!MoveFileExW(tempPath.wstring().c_str(), indexPath.wstring().c_str(), MOVEFILE_REPLACE_EXISTING)) {
+            WriteToAnimationsLog("WARNING: Scene index file still in use - new index kept in memory only", __LINE__);
+        }
+
+        auto elapsedMs =
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+        WriteToAnimationsLog("Scene index refreshed (" + reason + "): " + std::to_string(entries.size()) + " scenes, " +
+                                 std::to_string(toParse.size()) + " parsed on " + std::to_string(workerCount) +
+                                 " threads, " + std::to_string(reused) + " reused, " + std::to_string(parseFailures) +
+                                 " failed, " + std::to_string(elapsedMs) + " ms",
+                             __LINE__);
+    } catch (...) {
+        WriteToAnimationsLog("ERROR: Exception while refreshing scene index", __LINE__);
+    }
+}
+
+void StartSceneIndexBuild() {
+    if (g_sceneIndexThread.joinable()) {
         return;
     }
+    g_sceneIndexThread = std::thread([]() { RefreshSceneIndex("data loaded"); });
+}
 
-    if (!animationName.empty()) {
-        g_processedLines.insert(hashStr);
+bool LookupSceneMetadata(std::string_view sceneID, SceneIndexEntry& entry) {
+    auto index = GetSceneIndex();
+    if (!index) {
+        return false;
+    }
+    const SceneIndexEntry* found = index->Find(HashSceneID(sceneID));
+    if (!found) {
+        return false;
+    }
+    entry = *found;
+    return true;
+}
 
-        if (animationName == GetLastAnimation()) {
-            return;
+TagSet GetAnimationTags(const std::string& animationName) {
+    SceneIndexEntry entry;
+    if (LookupSceneMetadata(animationName, entry)) {
+        // The index only holds the built-in known tags, so user rules are matched on top of them.
+        TagSet tags = TagSet::FromBits(entry.tagBits);
+        if (auto rules = g_tagRuleAutomaton.load(std::memory_order_acquire)) {
+            tags |= rules->Match(animationName);
         }
+        return tags;
+    }
+    return TagAnalyzer::ExtractTagsFromAnimationName(animationName);
+}
 
-        SetLastAnimation(animationName);
-        AnalyzeAnimationForTags(animationName);
-        
-        if (!IsInOStimScene()) {
-            BuildNPCsCacheForScene();
-            
-            ActorInfo playerInfo = CapturePlayerInfo();
-            if (playerInfo.captured) {
-                g_sceneActors.push_back(playerInfo);
+// RunSceneTick is skipped during replay, so the cleanup delay runs in log time: CleanupDue fires on
+// the first line stamped kSceneCleanupDelayMs after the scene ended, or at the end of the file.
+void AdvanceReplayCleanupClock(long long logTimeMs, bool endOfFile) {
+    if (GetSceneState() != SceneState::Ending) {
+        g_replaySceneEndLogMs = -1;
+        return;
+    }
+    bool delayElapsed = g_replaySceneEndLogMs >= 0 && logTimeMs >= 0 &&
+                        (logTimeMs - g_replaySceneEndLogMs >= kSceneCleanupDelayMs || logTimeMs < g_replaySceneEndLogMs);
+    if (delayElapsed || endOfFile) {
+        g_replaySceneEndLogMs = -1;
+        ApplySceneInput({SceneInputKind::CleanupDue, SceneInputSource::Monitor, std::chrono::steady_clock::now(), ""});
+    }
+}
+
+void ResetSceneStateForReplay() {
+    SetInOStimScene(false);
+    SetLastAnimation("");
+    ResetSceneStateMachine();
+    g_goldRewardActive = false;
+    g_item1RewardActive = false;
+    g_item2RewardActive = false;
+    g_milkRewardActive = false;
+    g_milkWenchRewardActive = false;
+    g_milkEthelRewardActive = false;
+    g_attributesRestorationActive = false;
+    g_sceneTagStats.Reset(std::chrono::steady_clock::now());
+    g_currentAnimationInfo = AnimationTagInfo{};
+    g_sceneActors.clear();
+    g_scenePlayerPending = false;
+    g_detectedNPCNames.clear();
+    g_npcNameToRefID.clear();
+    g_processedLines.clear();
+    g_lastProcessedAnimationForTags = "";
+    g_lastOrgasmTimestamps.clear();
+    ClearOrgasmCounters();
+    ClearBloodyNoseCounters();
+    ClearAllThreadStates();
+}
+
+// Line splitting throughput over a synthetic OStim.log: each SIMD splitter against the
+// std::getline loop it replaced, with and without the marker pre-filter.
+void BenchmarkLogScanner(std::ostream& report) {
+    constexpr size_t kSyntheticBytes = 100 * 1024 * 1024;
+    static constexpr std::array<std::string_view, 6> kLineTemplates = {
+        "[12:34:56.789] [info] [Thread.cpp:195] thread 0 changed to node BB_Standing_Kiss_",
+        "[12:34:56.790] [info] [Graph.cpp:412] found for actor Lydia in node BB_Standing_Kiss_",
+        "[12:34:56.791] [debug] [ActorUtil.cpp:88] updating expression for actor 0x00013BB8 to neutral",
+        "[12:34:56.792] [info] [OStimMenu.h:48] UI_TransitionRequest {BB_Missionary_Sex_",
+        "[12:34:56.793] [trace] [Furniture.cpp:231] checking furniture reference 0x0001A2B4 at distance 112.5",
+        "[12:34:56.794] [info] [AlignmentStore.cpp:57] loaded alignment for Female/Male height 1.000000"};
+
+    std::string content;
+    content.reserve(kSyntheticBytes + 256);
+    for (size_t i = 0; content.size() < kSyntheticBytes; i++) {
+        content.append(kLineTemplates[i % kLineTemplates.size()]);
+        content.append(std::to_string(i % 97));
+        content.append(i % 3 == 0 ? "\r\n" : "\n");
+    }
+
+    struct Result {
+        const char* name;
+        long long splitNs;
+        long long filteredNs;
+        size_t lines;
+        size_t checksum;
+    };
+    std::vector<Result> results;
+
+    auto runSplitter = [&](const char* name, FindNewlineFunc findNewline) {
+        Result result{name, 0, 0, 0, 0};
+        for (bool filter : {false, true}) {
+            size_t lines = 0;
+            size_t checksum = 0;
+            auto start = std::chrono::steady_clock::now();
+            const char* cursor = content.data();
+            const char* end = content.data() + content.size();
+            while (cursor < end) {
+                const char* newlinePos = findNewline(cursor, end);
+                const char* lineStop = newlinePos ? newlinePos : end;
+                const char* contentEnd = lineStop > cursor && *(lineStop - 1) == '\r' ? lineStop - 1 : lineStop;
+                std::string_view line(cursor, contentEnd - cursor);
+                checksum += filter ? LineMayContainMarker(line) : line.size();
+                lines++;
+                cursor = lineStop + 1;
+            }
+            long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+            (filter ? result.filteredNs : result.splitNs) = ns;
+            result.lines = lines;
+            result.checksum += checksum;
+        }
+        results.push_back(result);
+    };
+
+    runSplitter("Scalar", FindNextNewlineScalar);
+    runSplitter("SSE2", FindNextNewlineSSE2);
+    if (IsAVX2Supported()) {
+        runSplitter("AVX2", FindNextNewlineAVX2);
+    }
+
+    Result getlineResult{"Getline", 0, 0, 0, 0};
+    for (bool filter : {false, true}) {
+        std::ispanstream stream(std::span<const char>(content.data(), content.size()));
+        std::string line;
+        size_t lines = 0;
+        size_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (std::getline(stream, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
             }
-            
-            CleanupTagBasedEffectsAtSceneStart();
-            
-            SetInOStimScene(true);
-            
-            WriteToOStimEventsLog("========================================", __LINE__);
-            WriteToOStimEventsLog("SCENE START EVENT", __LINE__);
-            WriteToOStimEventsLog("New OStim scene started", __LINE__);
-            WriteToOStimEventsLog("Starting animation: " + animationName, __LINE__);
-            WriteToOStimEventsLog("Initializing event monitoring systems", __LINE__);
-            WriteToOStimEventsLog("========================================", __LINE__);
-            
-            g_currentOStimTags.clear();
-            g_currentOStimSpeed = 0;
-            g_lastOStimEventCheck = std::chrono::steady_clock::now();
-            
-            ResolveItemFormIDs();
-            
-            g_lastGoldRewardTime = std::chrono::steady_clock::now();
-            g_goldRewardActive = true;
-            g_lastItem1RewardTime = std::chrono::steady_clock::now();
-            g_item1RewardActive = true;
-            g_lastItem2RewardTime = std::chrono::steady_clock::now();
-            g_item2RewardActive = true;
-            g_lastMilkRewardTime = std::chrono::steady_clock::now();
-            g_milkRewardActive = true;
-            g_lastMilkWenchRewardTime = std::chrono::steady_clock::now();
-            g_milkWenchRewardActive = true;
-            g_lastMilkEthelRewardTime = std::chrono::steady_clock::now();
-            g_milkEthelRewardActive = true;
-            g_lastAttributesRestorationTime = std::chrono::steady_clock::now();
-            g_attributesRestorationActive = true;
-            g_lastNPCDetectionCheck = std::chrono::steady_clock::now();
-            g_wenchMilkNPCDetected = false;
-            g_ethelNPCDetected = false;
+            checksum += filter ? LineMayContainMarker(line) : line.size();
+            lines++;
+        }
+        long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        (filter ? getlineResult.filteredNs : getlineResult.splitNs) = ns;
+        getlineResult.lines = lines;
+        getlineResult.checksum += checksum;
+    }
+    results.push_back(getlineResult);
 
-            WriteToActionsLog("OStim scene started - all reward systems activated", __LINE__);
-        } else {
-            RemoveTagBasedSpellEffects();
-            CheckAnimationTagsForSpellSystems(animationName, g_currentAnimationInfo.implicitTags);
+    auto bytesPerSecond = [&](long long ns) {
+        return ns > 0 ? static_cast<long long>(content.size() * 1000000000.0 / ns) : 0LL;
+    };
+
+    report << "[LogScanner]" << std::endl;
+    report << "Bytes=" << content.size() << std::endl;
+    report << "Lines=" << results.front().lines << std::endl;
+    report << "Active=" << (g_findNextNewline == FindNextNewlineAVX2 ? "AVX2" : "SSE2") << std::endl;
+    for (const auto& result : results) {
+        report << result.name << "BytesPerSecond=" << bytesPerSecond(result.splitNs) << std::endl;
+        report << result.name << "FilteredBytesPerSecond=" << bytesPerSecond(result.filteredNs) << std::endl;
+        if (result.lines != results.front().lines || result.checksum != results.front().checksum) {
+            report << result.name << "Mismatch=" << result.lines << " lines, checksum " << result.checksum << std::endl;
+        }
+    }
+    report << std::endl;
+}
+
+void BenchmarkPayloadParser(std::ostream& report) {
+    fs::path payloadPath = g_config.replay.payloadFile;
+    if (payloadPath.is_relative()) {
+        payloadPath = g_ostimLogPaths.primary / payloadPath;
+    }
+
+    std::ifstream payloadFile(payloadPath, std::ios::in | std::ios::binary);
+    if (!payloadFile.is_open()) {
+        return;
+    }
+
+    std::vector<std::string> payloads;
+    std::string line;
+    while (std::getline(payloadFile, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t contentPos = line.find("JSON Content: ");
+        std::string payload = contentPos != std::string::npos ? line.substr(contentPos + 14) : line;
+        if (OStimJsonReader::LooksLikeJson(payload)) {
+            payloads.push_back(std::move(payload));
+        }
+    }
+    payloadFile.close();
+
+    if (payloads.empty()) {
+        return;
+    }
+
+    constexpr int kIterations = 1000;
+    size_t parseFailures = 0;
+    size_t checksum = 0;
+
+    auto parserStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        for (const auto& payload : payloads) {
+            OStimEventPayload parsed;
+            if (OStimJsonReader::Parse(payload, parsed)) {
+                checksum += parsed.actorCount + parsed.tagCount + parsed.sceneID.size();
+            } else if (i == 0) {
+                parseFailures++;
+            }
+        }
+    }
+    auto parserNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - parserStart).count();
+
+    auto heuristicStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        for (const auto& payload : payloads) {
+            checksum += TagAnalyzer::ExtractTagsFromAnimationName(payload).Count();
+        }
+    }
+    auto heuristicNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - heuristicStart).count();
+
+    double events = static_cast<double>(payloads.size()) * kIterations;
+    report << "[PayloadParser]" << std::endl;
+    report << "File=" << payloadPath.string() << std::endl;
+    report << "Payloads=" << payloads.size() << std::endl;
+    report << "Iterations=" << kIterations << std::endl;
+    report << "ParseFailures=" << parseFailures << std::endl;
+    report << "ParserUsPerEvent=" << std::fixed << std::setprecision(3) << (parserNs / 1000.0 / events) << std::endl;
+    report << "SubstringHeuristicUsPerEvent=" << std::fixed << std::setprecision(3) << (heuristicNs / 1000.0 / events) << std::endl;
+    report << "Checksum=" << checksum << std::endl;
+    report << std::endl;
+}
+
+void BenchmarkTagKeywordAutomaton(std::ostream& report) {
+    fs::path scenesDir = GetPluginINIPath() / "OStim" / "scenes";
+
+    std::vector<std::string> sceneIDs;
+    std::error_code ec;
+    for (auto it = fs::recursive_directory_iterator(scenesDir, fs::directory_options::skip_permission_denied, ec);
+         !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_regular_file(ec) && it->path().extension() == ".json") {
+            sceneIDs.push_back(it->path().stem().string());
+        }
+    }
+
+    if (sceneIDs.empty()) {
+        return;
+    }
+
+    auto substringMatch = [](std::string_view sceneID) {
+        std::string lower(sceneID);
+        std::transform(lower.begin(), lower.end(), lower.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        uint32_t mask = 0;
+        for (const auto& entry : kAnimationTagKeywords) {
+            if (lower.find(entry.keyword) != std::string::npos) {
+                mask |= entry.tagBit;
+            }
+        }
+        return mask;
+    };
+
+    size_t mismatches = 0;
+    for (const auto& sceneID : sceneIDs) {
+        if (TagAnalyzer::ExtractTagMaskFromAnimationName(sceneID) != substringMatch(sceneID)) {
+            mismatches++;
+        }
+    }
+
+    constexpr int kIterations = 200;
+    uint64_t checksum = 0;
+
+    auto automatonStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        for (const auto& sceneID : sceneIDs) {
+            checksum += TagAnalyzer::ExtractTagMaskFromAnimationName(sceneID);
+        }
+    }
+    auto automatonNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - automatonStart).count();
+
+    auto substringStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; i++) {
+        for (const auto& sceneID : sceneIDs) {
+            checksum += substringMatch(sceneID);
+        }
+    }
+    auto substringNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - substringStart).count();
+
+    auto rules = g_tagRuleAutomaton.load(std::memory_order_acquire);
+    long long rulesNs = 0;
+    if (rules) {
+        auto rulesStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < kIterations; i++) {
+            for (const auto& sceneID : sceneIDs) {
+                checksum += rules->Match(sceneID).Count();
+            }
+        }
+        rulesNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - rulesStart).count();
+    }
+
+    double lookups = static_cast<double>(sceneIDs.size()) * kIterations;
+    report << "[TagKeywordAutomaton]" << std::endl;
+    report << "ScenesFolder=" << scenesDir.string() << std::endl;
+    report << "SceneIDs=" << sceneIDs.size() << std::endl;
+    report << "Iterations=" << kIterations << std::endl;
+    report << "AutomatonStates=" << kTagKeywordAutomaton.stateCount << std::endl;
+    report << "Mismatches=" << mismatches << std::endl;
+    report << "AutomatonNsPerID=" << std::fixed << std::setprecision(1) << (automatonNs / lookups) << std::endl;
+    report << "SubstringNsPerID=" << std::fixed << std::setprecision(1) << (substringNs / lookups) << std::endl;
+    if (rules) {
+        report << "TagRules=" << rules->ruleCount << std::endl;
+        report << "TagRuleStates=" << rules->StateCount() << std::endl;
+        report << "TagRuleNsPerID=" << std::fixed << std::setprecision(1) << (rulesNs / lookups) << std::endl;
+    }
+    report << "Checksum=" << checksum << std::endl;
+    report << std::endl;
+}
+
+void BenchmarkActorGrid(std::ostream& report) {
+    constexpr std::array<size_t, 3> kActorCounts = {50, 500, 5000};
+    constexpr std::array<float, 3> kRadii = {kMilkNPCDetectionRadius, kNPCRefIDSearchRadius, kSceneNPCCacheRadius};
+    constexpr int kQueries = 2000;
+    constexpr float kWorldExtent = 16384.0f;
+
+    report << "[ActorGrid]" << std::endl;
+    report << "CellSize=" << ActorGrid<RE::NiPoint3>::kCellSize << std::endl;
+    report << "Queries=" << kQueries << std::endl;
+
+    std::mt19937 rng(0x4F524953);
+    std::uniform_real_distribution<float> coordinate(-kWorldExtent, kWorldExtent);
+    std::uniform_real_distribution<float> height(-512.0f, 512.0f);
+
+    for (size_t actorCount : kActorCounts) {
+        WorldSnapshot world;
+        for (size_t i = 0; i < actorCount; i++) {
+            world.refIDs.push_back(static_cast<RE::FormID>(0xFF000800 + i));
+            world.baseIDs.push_back(static_cast<RE::FormID>(((i % 4) << 24) | (0x1000 + i % 64)));
+            world.positions.push_back(RE::NiPoint3(coordinate(rng), coordinate(rng), height(rng)));
+            world.female.push_back(static_cast<uint8_t>(i & 1));
+            world.nameIDs.push_back(static_cast<uint32_t>(i % 64));
+        }
+
+        auto buildStart = std::chrono::steady_clock::now();
+        world.grid.Build(world.positions);
+        auto buildNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - buildStart).count();
+
+        std::vector<RE::NiPoint3> centers;
+        for (int q = 0; q < kQueries; q++) {
+            centers.push_back(RE::NiPoint3(coordinate(rng), coordinate(rng), 0.0f));
+        }
+
+        for (float radius : kRadii) {
+            size_t mismatches = 0;
+            uint64_t gridHits = 0;
+            uint64_t linearHits = 0;
+
+            auto gridStart = std::chrono::steady_clock::now();
+            for (int q = 0; q < kQueries; q++) {
+                ActorFilter filter;
+                if (!(q & 1)) {
+                    filter.prefix = static_cast<RE::FormID>(q % 4) << 24;
+                    filter.mask = 0xFF000000;
+                }
+                world.ForEachInRadius(centers[q], radius, filter, [&](uint32_t) {
+                    gridHits++;
+                    return false;
+                });
+            }
+            auto gridNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - gridStart).count();
+
+            auto linearStart = std::chrono::steady_clock::now();
+            for (int q = 0; q < kQueries; q++) {
+                int modIndex = q & 1 ? -1 : q % 4;
+                for (size_t i = 0; i < world.Size(); i++) {
+                    if ((modIndex < 0 || static_cast<int>(world.baseIDs[i] >> 24) == modIndex) &&
+                        centers[q].GetDistance(world.positions[i]) <= radius) {
+                        linearHits++;
+                    }
+                }
+            }
+            auto linearNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - linearStart).count();
+
+            for (int q = 0; q < kQueries; q++) {
+                size_t gridCount = 0;
+                size_t linearCount = 0;
+                world.ForEachInRadius(centers[q], radius, {}, [&](uint32_t) {
+                    gridCount++;
+                    return false;
+                });
+                for (size_t i = 0; i < world.Size(); i++) {
+                    float dx = world.positions[i].x - centers[q].x;
+                    float dy = world.positions[i].y - centers[q].y;
+                    float dz = world.positions[i].z - centers[q].z;
+                    if (dx * dx + dy * dy + dz * dz <= radius * radius) {
+                        linearCount++;
+                    }
+                }
+                if (gridCount != linearCount) {
+                    mismatches++;
+                }
+            }
+
+            std::string prefix = "Actors" + std::to_string(actorCount) + "_R" + std::to_string(static_cast<int>(radius));
+            report << prefix << "_BuildNs=" << buildNs << std::endl;
+            report << prefix << "_Hits=" << gridHits << "/" << linearHits << std::endl;
+            report << prefix << "_Mismatches=" << mismatches << std::endl;
+            report << prefix << "_GridNsPerQuery=" << std::fixed << std::setprecision(1)
+                   << (static_cast<double>(gridNs) / kQueries) << std::endl;
+            report << prefix << "_LinearNsPerQuery=" << std::fixed << std::setprecision(1)
+                   << (static_cast<double>(linearNs) / kQueries) << std::endl;
+        }
+    }
+    report << std::endl;
+}
+
+void RunOStimLogReplay() {
+    fs::path replayPath = g_config.replay.file;
+    if (replayPath.is_relative()) {
+        replayPath = g_ostimLogPaths.primary / replayPath;
+    }
+
+    WriteToAnimationsLog("========================================", __LINE__);
+    WriteToAnimationsLog("OStim.log REPLAY MODE", __LINE__);
+    WriteToAnimationsLog("Replay file: " + replayPath.string(), __LINE__);
+    WriteToAnimationsLog(std::string("Timing: ") + (g_config.replay.realtime ? "original" : "maximum speed"), __LINE__);
+
+    std::ifstream replayFile(replayPath, std::ios::in | std::ios::binary);
+    if (!replayFile.is_open()) {
+        WriteToAnimationsLog("ERROR: Cannot open replay file - replay skipped", __LINE__);
+        WriteToAnimationsLog("========================================", __LINE__);
+        g_replayActive = false;
+        return;
+    }
+
+    std::string content((std::istreambuf_iterator<char>(replayFile)), std::istreambuf_iterator<char>());
+    replayFile.close();
+
+    g_replayActive = true;
+    RunOnSceneStrand([]() {
+        ResetSceneStateForReplay();
+        g_replayDecisions.clear();
+        g_replayDecisions.reserve(4096);
+        g_replayCurrentLine = 0;
+        g_replaySceneEndLogMs = -1;
+    });
+    InitializeNewlineSearch();
+
+    std::vector<uint32_t> lineLatenciesNs;
+    lineLatenciesNs.reserve(content.size() / 64 + 1);
+    g_replayAllocationCount = 0;
+
+    auto replayStopped = []() { return g_isShuttingDown.load() || g_replayStopRequested.load(); };
+
+    std::string lineBuffer;
+    lineBuffer.reserve(1024);
+
+    size_t linesSeen = 0;
+    size_t linesProcessed = 0;
+    bool havePreviousTimestamp = false;
+    long long previousTimestampMs = 0;
+    long long logTimeMs = -1;
+
+    const char* data = content.data();
+    const char* end = data + content.size();
+    const char* lineStart = data;
+    auto replayStartTime = std::chrono::steady_clock::now();
+
+    bool failed = false;
+    while (lineStart < end && !failed && !replayStopped()) {
+        const char* newlinePos = g_findNextNewline(lineStart, end);
+        const char* lineStop = newlinePos ? newlinePos : end;
+        const char* contentEnd = lineStop;
+        if (contentEnd > lineStart && *(contentEnd - 1) == '\r') {
+            --contentEnd;
+        }
+
+        std::string_view lineView(lineStart, contentEnd - lineStart);
+        linesSeen++;
+
+        long long timestampMs = 0;
+        bool hasTimestamp = ParseLogLineTimeOfDayMs(lineView, timestampMs);
+        if (hasTimestamp) {
+            logTimeMs = timestampMs;
+        }
+        if (g_config.replay.realtime) {
+            if (hasTimestamp) {
+                if (havePreviousTimestamp && timestampMs > previousTimestampMs) {
+                    auto wakeTime = std::chrono::steady_clock::now() +
+                                    std::chrono::milliseconds(timestampMs - previousTimestampMs);
+                    while (!replayStopped() && std::chrono::steady_clock::now() < wakeTime) {
+                        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                            std::chrono::milliseconds(100), wakeTime - std::chrono::steady_clock::now()));
+                    }
+                }
+                previousTimestampMs = timestampMs;
+                havePreviousTimestamp = true;
+            }
         }
 
-        if (g_processedLines.size() > 500) {
-            g_processedLines.clear();
-        }
+        // One line per strand task, so mod events and scene ticks interleave with the replay.
+        long long lineNs = 0;
+        RunOnSceneStrand([&]() {
+            g_replayCurrentLine = linesSeen;
+            t_replayThread = true;
+            auto lineStartTime = std::chrono::steady_clock::now();
+            t_countReplayAllocations = true;
+            try {
+                AdvanceReplayCleanupClock(logTimeMs, false);
+                if (ProcessOStimLogLine(lineView, lineBuffer)) {
+                    linesProcessed++;
+                }
+                if (GetSceneState() == SceneState::Ending && g_replaySceneEndLogMs < 0) {
+                    g_replaySceneEndLogMs = logTimeMs;
+                }
+            } catch (...) {
+                failed = true;
+            }
+            t_countReplayAllocations = false;
+            lineNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now() - lineStartTime)
+                         .count();
+            t_replayThread = false;
+        });
+        lineLatenciesNs.push_back(static_cast<uint32_t>(std::min<long long>(lineNs, UINT32_MAX)));
+
+        lineStart = lineStop + 1;
+    }
+    if (!failed && !replayStopped()) {
+        RunOnSceneStrand([&]() {
+            t_replayThread = true;
+            AdvanceReplayCleanupClock(logTimeMs, true);
+            t_replayThread = false;
+        });
+        // Lets the CleanupDone queued above run, so what it releases reaches the report.
+        RunOnSceneStrand([]() {});
+    }
+    if (failed) {
+        WriteToAnimationsLog("ERROR: Exception during replay - results are partial", __LINE__);
+    }
+
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                         std::chrono::steady_clock::now() - replayStartTime)
+                         .count();
+    size_t allocations = g_replayAllocationCount.load();
+
+    uint32_t p50 = 0;
+    uint32_t p99 = 0;
+    uint32_t maxLatency = 0;
+    if (!lineLatenciesNs.empty()) {
+        std::vector<uint32_t> sorted = lineLatenciesNs;
+        std::sort(sorted.begin(), sorted.end());
+        p50 = sorted[sorted.size() / 2];
+        p99 = sorted[std::min(sorted.size() - 1, (sorted.size() * 99) / 100)];
+        maxLatency = sorted.back();
+    }
+
+    double seconds = elapsedUs / 1000000.0;
+    double linesPerSecond = seconds > 0.0 ? linesSeen / seconds : 0.0;
+    double allocationsPerLine = linesSeen > 0 ? static_cast<double>(allocations) / linesSeen : 0.0;
+
+    auto logsFolder = SKSE::log::log_directory();
+    if (logsFolder) {
+        std::ofstream report(*logsFolder / "ORisk-and-Reward-NG-Replay.log", std::ios::trunc);
+        if (report.is_open()) {
+            report << "[Replay]" << std::endl;
+            report << "File=" << replayPath.string() << std::endl;
+            report << "Realtime=" << (g_config.replay.realtime ? "true" : "false") << std::endl;
+            report << "Bytes=" << content.size() << std::endl;
+            report << "Lines=" << linesSeen << std::endl;
+            report << "LinesPassedFilter=" << linesProcessed << std::endl;
+            report << "ElapsedMs=" << (elapsedUs / 1000) << std::endl;
+            report << "LinesPerSecond=" << static_cast<long long>(linesPerSecond) << std::endl;
+#ifdef ORISK_REPLAY_ALLOCATION_COUNTING
+            report << "AllocationsPerLine=" << std::fixed << std::setprecision(3) << allocationsPerLine << std::endl;
+#else
+            report << "AllocationsPerLine=not counted (build with ORISK_REPLAY_ALLOCATION_COUNTING)" << std::endl;
+#endif
+            report << "LatencyP50Ns=" << p50 << std::endl;
+            report << "LatencyP99Ns=" << p99 << std::endl;
+            report << "LatencyMaxNs=" << maxLatency << std::endl;
+            report << std::endl;
+            BenchmarkLogScanner(report);
+            BenchmarkPayloadParser(report);
+            BenchmarkTagKeywordAutomaton(report);
+            BenchmarkActorGrid(report);
+            report << "[Decisions]" << std::endl;
+            for (const auto& decision : g_replayDecisions) {
+                report << decision << std::endl;
+            }
+            report.close();
+        }
+    }
+
+    WriteToAnimationsLog("Replay finished: " + std::to_string(linesSeen) + " lines, " +
+                             std::to_string(g_replayDecisions.size()) + " decisions, " +
+                             std::to_string(static_cast<long long>(linesPerSecond)) + " lines/s, p99 " +
+                             std::to_string(p99) + " ns",
+                         __LINE__);
+    WriteToAnimationsLog("Results written to ORisk-and-Reward-NG-Replay.log", __LINE__);
+    WriteToAnimationsLog("========================================", __LINE__);
+
+    RunOnSceneStrand([]() {
+        g_replayDecisions.clear();
+        g_replayDecisions.shrink_to_fit();
+        ResetSceneStateForReplay();
+    });
+    g_replayActive = false;
+}
 
-        std::string formattedAnimation = "{" + animationName + "}";
-        WriteToAnimationsLog(formattedAnimation, __LINE__);
+void StopReplay() {
+    g_replayStopRequested = true;
+    if (g_replayThread.joinable()) {
+        g_replayThread.join();
     }
+    g_replayStopRequested = false;
 }
 
 void ProcessOStimLog() {
     try {
-        if (g_isShuttingDown.load()) {
+        if (g_isShuttingDown.load() || g_replayActive.load()) {
             return;
         }
 
@@ -4396,6 +7416,21 @@ void ProcessOStimLog() {
             }
         }
 
+        // Replay resets the scene strand's state, so it must never start over a live scene.
+        if (g_config.replay.enabled && !g_replayComplete.load()) {
+            if (!IsInOStimScene()) {
+                g_replayComplete = true;
+                StopReplay();
+                g_replayActive = true;
+                g_replayThread = std::thread(RunOStimLogReplay);
+                return;
+            }
+            if (!g_replayWaitLogged) {
+                g_replayWaitLogged = true;
+                WriteToAnimationsLog("Replay postponed until the current OStim scene ends", __LINE__);
+            }
+        }
+
         std::vector<fs::path> ostimLogPaths = {g_ostimLogPaths.primary / "OStim.log",
                                                g_ostimLogPaths.secondary / "OStim.log"};
 
@@ -4414,11 +7449,22 @@ void ProcessOStimLog() {
             return;
         }
 
+        // Historical lines go through untraced until catch-up (or the full-read fallback) has run.
+        if (!g_catchUpComplete) {
+            if (CatchUpOStimLog(activeOStimLogPath)) {
+                g_catchUpComplete = true;
+                return;
+            }
+            WriteToAnimationsLog("OStim.log catch-up unavailable - falling back to full read", __LINE__);
+        }
+
         size_t currentFileSize = fs::file_size(activeOStimLogPath);
         if (currentFileSize < g_lastFileSize) {
             g_lastOStimLogPosition = 0;
-            g_processedLines.clear();
-            SetLastAnimation("");
+            PostToSceneStrand([]() {
+                g_processedLines.clear();
+                SetLastAnimation("");
+            });
             WriteToAnimationsLog("OStim.log reset detected - restarting monitoring", __LINE__);
         } else if (currentFileSize == g_lastFileSize && g_lastOStimLogPosition > 0) {
             return;
@@ -4426,32 +7472,46 @@ void ProcessOStimLog() {
 
         g_lastFileSize = currentFileSize;
 
-        std::ifstream ostimLog(activeOStimLogPath, std::ios::in);
-        if (!ostimLog.is_open()) {
+        size_t startPosition = static_cast<size_t>(g_lastOStimLogPosition);
+        if (currentFileSize <= startPosition) {
             return;
         }
 
-        if (g_lastOStimLogPosition == 0) {
-            ostimLog.seekg(0, std::ios::beg);
-        } else {
-            ostimLog.seekg(g_lastOStimLogPosition);
+        std::ifstream ostimLog(activeOStimLogPath, std::ios::in | std::ios::binary);
+        if (!ostimLog.is_open()) {
+            return;
         }
 
-        std::string line;
-        while (std::getline(ostimLog, line)) {
-            size_t lineHash = std::hash<std::string>{}(line);
-            std::string hashStr = std::to_string(lineHash);
-            ProcessNewLine(line, hashStr);
-        }
+        ostimLog.seekg(static_cast<std::streamoff>(startPosition), std::ios::beg);
+
+        auto readStartTime = std::chrono::steady_clock::now();
+        g_ostimReadBuffer.resize(currentFileSize - startPosition);
+        ostimLog.read(g_ostimReadBuffer.data(), static_cast<std::streamsize>(g_ostimReadBuffer.size()));
+        size_t bytesRead = static_cast<size_t>(ostimLog.gcount());
+        ostimLog.close();
+
+        LogChunkStats stats = ProcessOStimLogChunk(g_ostimReadBuffer.data(), bytesRead);
+        g_catchUpComplete = true;
+        g_lastOStimLogPosition = static_cast<std::streamoff>(startPosition + stats.bytesConsumed);
 
-        g_lastOStimLogPosition = ostimLog.tellg();
-        if (ostimLog.eof()) {
-            ostimLog.clear();
-            ostimLog.seekg(0, std::ios::end);
-            g_lastOStimLogPosition = ostimLog.tellg();
+        if (bytesRead >= 65536) {
+            auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - readStartTime)
+                                 .count();
+            double megabytesPerSecond =
+                elapsedUs > 0 ? (static_cast<double>(bytesRead) / (1024.0 * 1024.0)) / (elapsedUs / 1000000.0) : 0.0;
+
+            WriteToAnimationsLog("Bulk OStim.log read: " + std::to_string(bytesRead) + " bytes, " +
+                                     std::to_string(stats.linesSeen) + " lines, " +
+                                     std::to_string(stats.linesProcessed) + " passed marker filter, " +
+                                     std::to_string(static_cast<int>(megabytesPerSecond)) + " MB/s",
+                                 __LINE__);
         }
 
-        ostimLog.close();
+        if (g_ostimReadBuffer.capacity() > 1024 * 1024) {
+            g_ostimReadBuffer.clear();
+            g_ostimReadBuffer.shrink_to_fit();
+        }
 
     } catch (const std::exception& e) {
         logger::error("Error processing OStim.log: {}", e.what());
@@ -4545,6 +7605,49 @@ void StopFileWatch() {
     }
 }
 
+// Scene start found no world snapshot yet; add the player once the game thread has captured one.
+void AddPendingScenePlayer() {
+    ActorInfo playerInfo = CapturePlayerInfo();
+    if (!playerInfo.captured) {
+        return;
+    }
+    g_scenePlayerPending = false;
+    if (g_sceneActors.Insert(playerInfo, 0.0f)) {
+        CleanupTagBasedEffectsAtSceneStart({playerInfo});
+        WriteToOStimEventsLog("Player added to scene from world snapshot", __LINE__);
+    }
+}
+
+void RunSceneTick() {
+    if (g_replayActive.load()) {
+        g_sceneTickPending = false;
+        return;
+    }
+    if (GetSceneState() == SceneState::Ending) {
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - g_sceneEndTime).count();
+        if (elapsed >= kSceneCleanupDelayMs) {
+            ApplySceneInput({SceneInputKind::CleanupDue, SceneInputSource::Monitor, now, ""});
+        }
+    }
+    if (g_scenePlayerPending && IsInOStimScene()) {
+        AddPendingScenePlayer();
+    }
+    FindAndCacheNPCRefIDs();
+    CheckForNearbyNPCs();
+    CheckAndRewardGold();
+    CheckAndRewardItem1();
+    CheckAndRewardItem2();
+    CheckAndRewardMilk();
+    CheckAndRewardMilkWench();
+    CheckAndRewardMilkEthel();
+    CheckExpiredSpellEffects();
+    CheckBloodyNoseCounters();
+    CheckAndRestoreAttributes();
+    ProcessPendingSpellCasts();
+    g_sceneTickPending = false;
+}
+
 void MonitoringThreadFunction() {
     WriteToAnimationsLog("Monitoring thread started - Watching OStim.log for animations", __LINE__);
     WriteToAnimationsLog("Monitoring OStim.log on dual paths (Primary & Secondary)", __LINE__);
@@ -4557,40 +7660,13 @@ void MonitoringThreadFunction() {
 
     while (g_monitoringActive && !g_isShuttingDown.load()) {
         g_monitorCycles++;
-        
-        if (g_cleanupPending) {
-            auto now = std::chrono::steady_clock::now();
-            auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - g_sceneEndTime).count();
-            
-            if (elapsed >= 1) {
-                WriteToOStimEventsLog("========================================", __LINE__);
-                WriteToOStimEventsLog("EXECUTING DELAYED CLEANUP (1 second after OStim end)", __LINE__);
-                WriteToOStimEventsLog("========================================", __LINE__);
-                
-                CleanupSpellEffectsFromLog();
-                CleanupSpellEffectsByFaction();
-                DeactivateAllSpellEffects();
-                
-                g_cleanupPending = false;
-                
-                WriteToOStimEventsLog("Delayed cleanup completed successfully", __LINE__);
-            }
-        }
-        
         ProcessOStimLog();
-        FindAndCacheNPCRefIDs();
-        CheckForNearbyNPCs();
-        ProcessOStimEventData();
-        CheckAndRewardGold();
-        CheckAndRewardItem1();
-        CheckAndRewardItem2();
-        CheckAndRewardMilk();
-        CheckAndRewardMilkWench();
-        CheckAndRewardMilkEthel();
-        CheckExpiredSpellEffects();
-        CheckBloodyNoseCounters();
-        CheckAndRestoreAttributes();
-        ProcessPendingSpellCasts();
+        if (IsInOStimScene()) {
+            RequestWorldSnapshot();
+        }
+        if (!g_sceneTickPending.exchange(true)) {
+            PostToSceneStrand(RunSceneTick);
+        }
         std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     }
 }
@@ -4601,62 +7677,70 @@ void StartMonitoringThread() {
         g_monitorCycles = 0;
         g_lastOStimLogPosition = 0;
         g_lastFileSize = 0;
-        g_processedLines.clear();
-        SetLastAnimation("");
         g_initialDelayComplete = false;
-        SetInOStimScene(false);
-        g_goldRewardActive = false;
-        g_item1RewardActive = false;
-        g_item2RewardActive = false;
-        g_milkRewardActive = false;
-        g_milkWenchRewardActive = false;
-        g_milkEthelRewardActive = false;
-        g_attributesRestorationActive = false;
-        g_wenchMilkNPCDetected = false;
-        g_ethelNPCDetected = false;
-        g_capturedYurianaWenchNPC.captured = false;
-        g_capturedYurianaWenchNPC.formID = 0;
-        g_capturedEthelNPC.captured = false;
-        g_capturedEthelNPC.formID = 0;
-        g_cachedItemFormIDs.resolved = false;
-        g_cachedItemFormIDs.item1 = 0;
-        g_cachedItemFormIDs.item2 = 0;
-        g_cachedItemFormIDs.milkDawnguard = 0;
-        g_cachedItemFormIDs.milkWench = 0;
-        g_cachedItemFormIDs.milkEthel = 0;
-        g_cachedItemFormIDs.item1Event = 0;
-        g_cachedItemFormIDs.item2Event = 0;
-        g_cachedItemFormIDs.milkEvent = 0;
-        g_cachedItemFormIDs.milkWenchEvent = 0;
-        g_cachedItemFormIDs.milkEthelEvent = 0;
-        g_cachedSpellFormIDs.resolved = false;
-        g_cachedSpellFormIDs.emotionalTearsNPC = 0;
-        g_cachedSpellFormIDs.emotionalTearsPlayer = 0;
-        g_cachedSpellFormIDs.vampireTearsNPC = 0;
-        g_cachedSpellFormIDs.vampireTearsPlayer = 0;
-        g_cachedSpellFormIDs.bloodyNoseNPC = 0;
-        g_cachedSpellFormIDs.bloodyNosePlayer = 0;
-        g_cachedFactionIDs.resolved = false;
-        g_cachedFactionIDs.emotionalTearsFaction = 0;
-        g_cachedFactionIDs.vampireTearsFaction = 0;
-        g_cachedFactionIDs.bloodyNoseFaction = 0;
-        g_detectedNPCNames.clear();
-        g_npcNameToRefID.clear();
-        g_activeSpellEffects.clear();
-        g_currentOStimTags.clear();
-        g_currentOStimSpeed = 0;
-        g_currentAnimationInfo = AnimationTagInfo{};
-        g_sceneActors.clear();
-        g_lastOrgasmTimestamps.clear();
-        g_pendingSpellCasts.clear();
-        g_wenchPluginChecked = false;
-        g_wenchPluginExists = false;
-        g_ethelPluginChecked = false;
-        g_ethelPluginExists = false;
-        g_lastProcessedAnimationForTags = "";
-        ClearOrgasmCounters();
-        ClearBloodyNoseCounters();
-        CheckVampireTearsPluginAvailability();
+        g_catchUpComplete = false;
+        g_replayComplete = false;
+        g_replayWaitLogged = false;
+        PostToSceneStrand([]() {
+            g_processedLines.clear();
+            SetLastAnimation("");
+            ClearAllThreadStates();
+            ResetSceneStateMachine();
+            SetInOStimScene(false);
+            g_goldRewardActive = false;
+            g_item1RewardActive = false;
+            g_item2RewardActive = false;
+            g_milkRewardActive = false;
+            g_milkWenchRewardActive = false;
+            g_milkEthelRewardActive = false;
+            g_attributesRestorationActive = false;
+            g_wenchMilkNPCDetected = false;
+            g_ethelNPCDetected = false;
+            g_capturedYurianaWenchNPC.captured = false;
+            g_capturedYurianaWenchNPC.formID = 0;
+            g_capturedEthelNPC.captured = false;
+            g_capturedEthelNPC.formID = 0;
+            g_cachedItemFormIDs.resolved = false;
+            g_cachedItemFormIDs.item1 = 0;
+            g_cachedItemFormIDs.item2 = 0;
+            g_cachedItemFormIDs.milkDawnguard = 0;
+            g_cachedItemFormIDs.milkWench = 0;
+            g_cachedItemFormIDs.milkEthel = 0;
+            g_cachedItemFormIDs.item1Event = 0;
+            g_cachedItemFormIDs.item2Event = 0;
+            g_cachedItemFormIDs.milkEvent = 0;
+            g_cachedItemFormIDs.milkWenchEvent = 0;
+            g_cachedItemFormIDs.milkEthelEvent = 0;
+            g_cachedSpellFormIDs.resolved = false;
+            g_cachedSpellFormIDs.emotionalTearsNPC = 0;
+            g_cachedSpellFormIDs.emotionalTearsPlayer = 0;
+            g_cachedSpellFormIDs.vampireTearsNPC = 0;
+            g_cachedSpellFormIDs.vampireTearsPlayer = 0;
+            g_cachedSpellFormIDs.bloodyNoseNPC = 0;
+            g_cachedSpellFormIDs.bloodyNosePlayer = 0;
+            g_cachedFactionIDs.resolved = false;
+            g_cachedFactionIDs.emotionalTearsFaction = 0;
+            g_cachedFactionIDs.vampireTearsFaction = 0;
+            g_cachedFactionIDs.bloodyNoseFaction = 0;
+            g_detectedNPCNames.clear();
+            g_npcNameToRefID.clear();
+            g_activeSpellEffects.clear();
+            g_sceneTagStats.Reset(std::chrono::steady_clock::now());
+            g_currentAnimationInfo = AnimationTagInfo{};
+            g_sceneActors.clear();
+            g_scenePlayerPending = false;
+            g_lastOrgasmTimestamps.clear();
+            g_pendingSpellCasts.clear();
+            g_wenchPluginChecked = false;
+            g_wenchPluginExists = false;
+            g_ethelPluginChecked = false;
+            g_ethelPluginExists = false;
+            g_lastProcessedAnimationForTags = "";
+            ClearOrgasmCounters();
+            ClearBloodyNoseCounters();
+            CheckVampireTearsPluginAvailability();
+        });
+        InitializeNewlineSearch();
         g_monitorThread = std::thread(MonitoringThreadFunction);
 
         WriteToAnimationsLog("MONITORING SYSTEM ACTIVATED", __LINE__);
@@ -4670,6 +7754,7 @@ void StopMonitoringThread() {
             g_monitorThread.join();
         }
     }
+    g_replayStopRequested = true;
 }
 
 void CheckAndRewardGold() {
@@ -4982,18 +8067,14 @@ void CheckAndRewardMilk() {
 }
 
 void TryCaptureNPCFormIDs() {
-    auto* player = RE::PlayerCharacter::GetSingleton();
-    if (!player) return;
-    
-    auto* processLists = RE::ProcessLists::GetSingleton();
-    if (!processLists) return;
+    auto world = GetWorldSnapshot();
+    if (!world) return;
     
-    RE::NiPoint3 playerPos = player->GetPosition();
-    auto* dataHandler = RE::TESDataHandler::GetSingleton();
-    if (!dataHandler) return;
+    auto plugins = GetPluginIndex();
+    if (!plugins) return;
     
     if (!g_wenchPluginChecked) {
-        g_wenchPluginExists = (dataHandler->LookupModByName(g_config.milkWench.plugin) != nullptr);
+        g_wenchPluginExists = (plugins->Find(g_config.milkWench.plugin) != nullptr);
         g_wenchPluginChecked = true;
         
         if (g_wenchPluginExists) {
@@ -5004,7 +8085,7 @@ void TryCaptureNPCFormIDs() {
     }
     
     if (!g_ethelPluginChecked) {
-        g_ethelPluginExists = (dataHandler->LookupModByName(g_config.milkEthel.pluginNPC) != nullptr);
+        g_ethelPluginExists = (plugins->Find(g_config.milkEthel.pluginNPC) != nullptr);
         g_ethelPluginChecked = true;
         
         if (g_ethelPluginExists) {
@@ -5015,45 +8096,17 @@ void TryCaptureNPCFormIDs() {
     }
     
     if (g_config.milkWench.enabled && g_wenchPluginExists && !g_capturedYurianaWenchNPC.captured) {
-        auto* file = dataHandler->LookupModByName(g_config.milkWench.plugin);
-        if (file) {
-            uint8_t modIndex = file->compileIndex;
-            if (modIndex == 0xFF) {
-                modIndex = file->smallFileCompileIndex;
-            }
-            
-            auto searchInList = [&](auto& actorHandles) -> bool {
-                for (auto& actorHandle : actorHandles) {
-                    auto actor = actorHandle.get();
-                    if (!actor) continue;
-                    
-                    auto* actorBase = actor->GetActorBase();
-                    if (!actorBase) continue;
-                    
-                    uint8_t npcModIndex = (actorBase->formID >> 24) & 0xFF;
-                    if (npcModIndex == modIndex) {
-                        RE::NiPoint3 npcPos = actor->GetPosition();
-                        float distance = playerPos.GetDistance(npcPos);
-                        
-                        if (distance <= 500.0f) {
-                            g_capturedYurianaWenchNPC.formID = actorBase->formID;
-                            g_capturedYurianaWenchNPC.pluginName = g_config.milkWench.plugin;
-                            g_capturedYurianaWenchNPC.captured = true;
-                            g_capturedYurianaWenchNPC.lastSeen = std::chrono::steady_clock::now();
-                            
-                            WriteToActionsLog("Auto-captured YurianaWench NPC", __LINE__);
-                            return true;
-                        }
-                    }
-                }
-                return false;
-            };
-            
-            if (!searchInList(processLists->highActorHandles)) {
-                if (!searchInList(processLists->middleHighActorHandles)) {
-                    searchInList(processLists->lowActorHandles);
-                }
-            }
+        auto* plugin = plugins->Find(g_config.milkWench.plugin);
+        if (plugin) {
+            world->ForEachNearPlayer(kMilkNPCDetectionRadius, ActorFilter::FromPlugin(*plugin), [&](uint32_t i) {
+                g_capturedYurianaWenchNPC.formID = world->baseIDs[i];
+                g_capturedYurianaWenchNPC.pluginName = g_config.milkWench.plugin;
+                g_capturedYurianaWenchNPC.captured = true;
+                g_capturedYurianaWenchNPC.lastSeen = std::chrono::steady_clock::now();
+                
+                WriteToActionsLog("Auto-captured YurianaWench NPC", __LINE__);
+                return true;
+            });
         }
     }
     
@@ -5067,37 +8120,15 @@ void TryCaptureNPCFormIDs() {
         RE::FormID targetFormID = GetFormIDFromPlugin(g_config.milkEthel.pluginNPC, cleanID);
         
         if (targetFormID != 0) {
-            auto searchInList = [&](auto& actorHandles) -> bool {
-                for (auto& actorHandle : actorHandles) {
-                    auto actor = actorHandle.get();
-                    if (!actor) continue;
-                    
-                    auto* actorBase = actor->GetActorBase();
-                    if (!actorBase) continue;
-                    
-                    if (actorBase->formID == targetFormID) {
-                        RE::NiPoint3 npcPos = actor->GetPosition();
-                        float distance = playerPos.GetDistance(npcPos);
-                        
-                        if (distance <= 500.0f) {
-                            g_capturedEthelNPC.formID = targetFormID;
-                            g_capturedEthelNPC.pluginName = g_config.milkEthel.pluginNPC;
-                            g_capturedEthelNPC.captured = true;
-                            g_capturedEthelNPC.lastSeen = std::chrono::steady_clock::now();
-                            
-                            WriteToActionsLog("Auto-captured Ethel NPC", __LINE__);
-                            return true;
-                        }
-                    }
-                }
-                return false;
-            };
-            
-            if (!searchInList(processLists->highActorHandles)) {
-                if (!searchInList(processLists->middleHighActorHandles)) {
-                    searchInList(processLists->lowActorHandles);
-                }
-            }
+            world->ForEachNearPlayer(kMilkNPCDetectionRadius, ActorFilter::ForBase(targetFormID), [&](uint32_t) {
+                g_capturedEthelNPC.formID = targetFormID;
+                g_capturedEthelNPC.pluginName = g_config.milkEthel.pluginNPC;
+                g_capturedEthelNPC.captured = true;
+                g_capturedEthelNPC.lastSeen = std::chrono::steady_clock::now();
+                
+                WriteToActionsLog("Auto-captured Ethel NPC", __LINE__);
+                return true;
+            });
         }
     }
 }
@@ -5126,13 +8157,13 @@ void CheckForNearbyNPCs() {
         bool isNearby = false;
         
         if (g_capturedYurianaWenchNPC.captured) {
-            isNearby = IsSpecificNPCNearPlayer(g_capturedYurianaWenchNPC.formID, 500.0f);
+            isNearby = IsSpecificNPCNearPlayer(g_capturedYurianaWenchNPC.formID, kMilkNPCDetectionRadius);
             
             if (isNearby) {
                 g_capturedYurianaWenchNPC.lastSeen = now;
             }
         } else {
-            isNearby = IsAnyNPCFromPluginNearPlayer(g_config.milkWench.plugin, 500.0f);
+            isNearby = IsAnyNPCFromPluginNearPlayer(g_config.milkWench.plugin, kMilkNPCDetectionRadius);
         }
         
         if (isNearby && !g_wenchMilkNPCDetected) {
@@ -5151,7 +8182,7 @@ void CheckForNearbyNPCs() {
         bool isNearby = false;
         
         if (g_capturedEthelNPC.captured) {
-            isNearby = IsSpecificNPCNearPlayer(g_capturedEthelNPC.formID, 500.0f);
+            isNearby = IsSpecificNPCNearPlayer(g_capturedEthelNPC.formID, kMilkNPCDetectionRadius);
             
             if (isNearby) {
                 g_capturedEthelNPC.lastSeen = now;
@@ -5673,6 +8704,108 @@ void SaveDefaultConfiguration() {
     WriteToActionsLog("All default configuration files created successfully", __LINE__);
 }
 
+void SaveDefaultReplayConfiguration(const fs::path& replayPath) {
+    std::ofstream file(replayPath, std::ios::trunc);
+    if (!file.is_open()) {
+        WriteToActionsLog("ERROR: Failed to create replay configuration file: " + replayPath.string(), __LINE__);
+        return;
+    }
+
+    file << "[Replay]" << std::endl;
+    file << "Enabled=false" << std::endl;
+    file << "File=OStim-replay.log" << std::endl;
+    file << "Realtime=false" << std::endl;
+    file << "PayloadFile=OStim-payloads.log" << std::endl;
+
+    file.close();
+    WriteToActionsLog("Created: " + replayPath.filename().string(), __LINE__);
+}
+
+void SaveDefaultTagRules(const fs::path& rulesPath) {
+    std::ofstream file(rulesPath, std::ios::trunc);
+    if (!file.is_open()) {
+        WriteToActionsLog("ERROR: Failed to create tag rules file: " + rulesPath.string(), __LINE__);
+        return;
+    }
+
+    file << "; Animation tag rules, matched case-insensitively against OStim scene IDs." << std::endl;
+    file << "; keyword = Tag[, word|prefix|suffix][, !exclusion ...]" << std::endl;
+    file << ";   word/prefix/suffix  keyword must be a whole word / start a word / end a word." << std::endl;
+    file << ";                       Words are delimited by non-letters and the ends of the scene ID." << std::endl;
+    file << ";   !exclusion          rule is skipped when the exclusion text appears in the scene ID." << std::endl;
+    file << "; Tags other than the built-in OStim tags are added as custom tags." << std::endl;
+    file << "[Rules]" << std::endl;
+    for (const auto& entry : kAnimationTagKeywords) {
+        file << entry.keyword << " = " << kSceneTagNames[std::countr_zero(entry.tagBit)];
+        if (entry.keyword == "dom") {
+            file << ", !random";
+        } else if (entry.keyword == "hard") {
+            file << ", !orchard";
+        }
+        file << std::endl;
+    }
+
+    file.close();
+    WriteToActionsLog("Created: " + rulesPath.filename().string(), __LINE__);
+}
+
+std::shared_ptr<const TagRuleAutomaton> CompileTagRules(const fs::path& rulesPath) {
+    std::ifstream file(rulesPath);
+    if (!file.is_open()) {
+        WriteToActionsLog("ERROR: Failed to open tag rules file: " + rulesPath.string(), __LINE__);
+        return nullptr;
+    }
+
+    return CompileTagRules(
+        file, [](std::string_view tag) { return TagNameTable::Get().InternConfigured(tag); },
+        [](const std::string& message) { WriteToActionsLog(message, __LINE__); });
+}
+
+void ReloadTagRulesIfChanged(const fs::path& rulesPath) {
+    std::error_code ec;
+    if (!fs::exists(rulesPath, ec)) {
+        SaveDefaultTagRules(rulesPath);
+    }
+
+    fs::file_time_type writeTime = fs::last_write_time(rulesPath, ec);
+    if (ec || writeTime == g_tagRulesWriteTime || g_tagRulesCompiling.load()) {
+        return;
+    }
+    g_tagRulesWriteTime = writeTime;
+    g_tagRulesCompiling = true;
+
+    if (g_tagRulesThread.joinable()) {
+        g_tagRulesThread.join();
+    }
+    g_tagRulesThread = std::thread([rulesPath]() {
+        try {
+            if (auto automaton = CompileTagRules(rulesPath)) {
+                g_tagRuleAutomaton.store(std::move(automaton), std::memory_order_release);
+                g_configVersion.fetch_add(1, std::memory_order_release);
+            }
+        } catch (...) {
+            WriteToActionsLog("ERROR: Exception while compiling tag rules", __LINE__);
+        }
+        g_tagRulesCompiling = false;
+    });
+}
+
+// Give every tag named in the INI a TagSet bit up front, before metadata tags can claim them.
+void InternConfiguredTags() {
+    for (const std::string* list : {&g_config.emotionalTearsNPC.tagsNameAnimationList,
+                                    &g_config.emotionalTearsPlayer.tagsNameAnimationList,
+                                    &g_config.vampireTearsNPC.tagsNameAnimationList,
+                                    &g_config.vampireTearsPlayer.tagsNameAnimationList,
+                                    &g_config.bloodyNoseNPC.tagsNameAnimationList,
+                                    &g_config.bloodyNosePlayer.tagsNameAnimationList}) {
+        for (const auto& tag : SplitString(*list, ',')) {
+            if (TagNameTable::Get().InternConfigured(tag) == kInvalidTagID) {
+                WriteToActionsLog("Configured tag '" + tag + "' not tracked, tag table full", __LINE__);
+            }
+        }
+    }
+}
+
 bool LoadConfiguration() {
     std::lock_guard<std::mutex> lock(g_configMutex);
 
@@ -5700,6 +8833,14 @@ bool LoadConfiguration() {
         SaveDefaultConfiguration();
     }
     
+    // Created on its own so that adding it does not rewrite the existing feature files.
+    fs::path replayIniPath = configDir / "ORisk-and-Reward-NG-Replay.ini";
+    if (!fs::exists(replayIniPath)) {
+        SaveDefaultReplayConfiguration(replayIniPath);
+    }
+    iniFiles.push_back(replayIniPath);
+    
+    size_t contentHash = 0;
     for (const auto& iniPath : iniFiles) {
         if (!fs::exists(iniPath)) {
             WriteToActionsLog("WARNING: INI file does not exist after creation attempt: " + iniPath.string(), __LINE__);
@@ -5723,6 +8864,8 @@ bool LoadConfiguration() {
                 continue;
             }
 
+            contentHash = (contentHash ^ std::hash<std::string>{}(line)) * 1099511628211ull;
+
             if (line[0] == '[' && line[line.length() - 1] == ']') {
                 currentSection = line.substr(1, line.length() - 2);
                 continue;
@@ -6254,6 +9397,16 @@ bool LoadConfiguration() {
                     if (key == "Enabled") {
                         g_config.notification.enabled = (value == "1" || value == "true" || value == "True");
                     }
+                } else if (currentSection == "Replay") {
+                    if (key == "Enabled") {
+                        g_config.replay.enabled = (value == "1" || value == "true" || value == "True");
+                    } else if (key == "File") {
+                        g_config.replay.file = value;
+                    } else if (key == "Realtime") {
+                        g_config.replay.realtime = (value == "1" || value == "true" || value == "True");
+                    } else if (key == "PayloadFile") {
+                        g_config.replay.payloadFile = value;
+                    }
                 }
             }
         }
@@ -6261,6 +9414,14 @@ bool LoadConfiguration() {
         iniFile.close();
     }
     
+    if (contentHash != g_configContentHash) {
+        g_configContentHash = contentHash;
+        g_configVersion.fetch_add(1, std::memory_order_release);
+    }
+    
+    InternConfiguredTags();
+    ReloadTagRulesIfChanged(configDir / "ORisk-and-Reward-NG-TagRules.ini");
+    
     return true;
 }
 
@@ -6849,6 +10010,8 @@ void InitializePlugin() {
             WriteToOStimEventsLog("WARNING: Failed to register Mod Event Sink - OStim events will not be detected", __LINE__);
         }
 
+        StartEventWorker();
+
         StartMonitoringThread();
         StartFileWatch();
 
@@ -6864,10 +10027,6 @@ void ShutdownPlugin() {
 
     g_isShuttingDown = true;
 
-    CleanupSpellEffectsFromLog();
-    CleanupSpellEffectsByFaction();
-    DeactivateAllSpellEffects();
-
     auto* modEventSource = SKSE::GetModCallbackEventSource();
     if (modEventSource) {
         modEventSource->RemoveEventSink(&OStimModEventSink::GetSingleton());
@@ -6876,6 +10035,32 @@ void ShutdownPlugin() {
 
     StopFileWatch();
     StopMonitoringThread();
+    StopReplay();
+
+    StopEventWorker();
+    DumpEventQueueStats("shutdown");
+
+    CleanupSpellEffectsFromLog();
+    CleanupSpellEffectsByFaction();
+    DeactivateAllSpellEffects();
+
+    if (g_sceneIndexThread.joinable()) {
+        g_sceneIndexThread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_sceneIndexBuildMutex);
+        if (g_sceneIndexWatch != INVALID_HANDLE_VALUE) {
+            FindCloseChangeNotification(g_sceneIndexWatch);
+            g_sceneIndexWatch = INVALID_HANDLE_VALUE;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_configMutex);
+        if (g_tagRulesThread.joinable()) {
+            g_tagRulesThread.join();
+        }
+    }
 
     WriteToAnimationsLog("========================================", __LINE__);
     WriteToAnimationsLog("Plugin shutdown complete at: " + GetCurrentTimeString(), __LINE__);
@@ -6893,63 +10078,68 @@ void MessageListener(SKSE::MessagingInterface::Message* message) {
             StopMonitoringThread();
             g_lastOStimLogPosition = 0;
             g_lastFileSize = 0;
-            g_processedLines.clear();
-            SetLastAnimation("");
             g_initialDelayComplete = false;
-            SetInOStimScene(false);
-            g_goldRewardActive = false;
-            g_item1RewardActive = false;
-            g_item2RewardActive = false;
-            g_milkRewardActive = false;
-            g_milkWenchRewardActive = false;
-            g_milkEthelRewardActive = false;
-            g_attributesRestorationActive = false;
-            g_wenchMilkNPCDetected = false;
-            g_ethelNPCDetected = false;
-            g_capturedYurianaWenchNPC.captured = false;
-            g_capturedYurianaWenchNPC.formID = 0;
-            g_capturedEthelNPC.captured = false;
-            g_capturedEthelNPC.formID = 0;
-            g_cachedItemFormIDs.resolved = false;
-            g_cachedItemFormIDs.item1 = 0;
-            g_cachedItemFormIDs.item2 = 0;
-            g_cachedItemFormIDs.milkDawnguard = 0;
-            g_cachedItemFormIDs.milkWench = 0;
-            g_cachedItemFormIDs.milkEthel = 0;
-            g_cachedItemFormIDs.item1Event = 0;
-            g_cachedItemFormIDs.item2Event = 0;
-            g_cachedItemFormIDs.milkEvent = 0;
-            g_cachedItemFormIDs.milkWenchEvent = 0;
-            g_cachedItemFormIDs.milkEthelEvent = 0;
-            g_cachedSpellFormIDs.resolved = false;
-            g_cachedSpellFormIDs.emotionalTearsNPC = 0;
-            g_cachedSpellFormIDs.emotionalTearsPlayer = 0;
-            g_cachedSpellFormIDs.vampireTearsNPC = 0;
-            g_cachedSpellFormIDs.vampireTearsPlayer = 0;
-            g_cachedSpellFormIDs.bloodyNoseNPC = 0;
-            g_cachedSpellFormIDs.bloodyNosePlayer = 0;
-            g_cachedFactionIDs.resolved = false;
-            g_cachedFactionIDs.emotionalTearsFaction = 0;
-            g_cachedFactionIDs.vampireTearsFaction = 0;
-            g_cachedFactionIDs.bloodyNoseFaction = 0;
-            g_detectedNPCNames.clear();
-            g_npcNameToRefID.clear();
-            g_activeSpellEffects.clear();
-            g_currentOStimTags.clear();
-            g_currentOStimSpeed = 0;
-            g_currentAnimationInfo = AnimationTagInfo{};
-            g_sceneActors.clear();
-            g_lastOrgasmTimestamps.clear();
-            g_pendingSpellCasts.clear();
-            g_wenchPluginChecked = false;
-            g_wenchPluginExists = false;
-            g_ethelPluginChecked = false;
-            g_ethelPluginExists = false;
-            g_lastProcessedAnimationForTags = "";
-            g_vampireTearsPluginDetected = false;
-            ClearOrgasmCounters();
-            ClearBloodyNoseCounters();
-            CheckVampireTearsPluginAvailability();
+            g_catchUpComplete = false;
+            PostToSceneStrand([]() {
+                g_processedLines.clear();
+                SetLastAnimation("");
+                ResetSceneStateMachine();
+                SetInOStimScene(false);
+                g_goldRewardActive = false;
+                g_item1RewardActive = false;
+                g_item2RewardActive = false;
+                g_milkRewardActive = false;
+                g_milkWenchRewardActive = false;
+                g_milkEthelRewardActive = false;
+                g_attributesRestorationActive = false;
+                g_wenchMilkNPCDetected = false;
+                g_ethelNPCDetected = false;
+                g_capturedYurianaWenchNPC.captured = false;
+                g_capturedYurianaWenchNPC.formID = 0;
+                g_capturedEthelNPC.captured = false;
+                g_capturedEthelNPC.formID = 0;
+                g_cachedItemFormIDs.resolved = false;
+                g_cachedItemFormIDs.item1 = 0;
+                g_cachedItemFormIDs.item2 = 0;
+                g_cachedItemFormIDs.milkDawnguard = 0;
+                g_cachedItemFormIDs.milkWench = 0;
+                g_cachedItemFormIDs.milkEthel = 0;
+                g_cachedItemFormIDs.item1Event = 0;
+                g_cachedItemFormIDs.item2Event = 0;
+                g_cachedItemFormIDs.milkEvent = 0;
+                g_cachedItemFormIDs.milkWenchEvent = 0;
+                g_cachedItemFormIDs.milkEthelEvent = 0;
+                g_cachedSpellFormIDs.resolved = false;
+                g_cachedSpellFormIDs.emotionalTearsNPC = 0;
+                g_cachedSpellFormIDs.emotionalTearsPlayer = 0;
+                g_cachedSpellFormIDs.vampireTearsNPC = 0;
+                g_cachedSpellFormIDs.vampireTearsPlayer = 0;
+                g_cachedSpellFormIDs.bloodyNoseNPC = 0;
+                g_cachedSpellFormIDs.bloodyNosePlayer = 0;
+                g_cachedFactionIDs.resolved = false;
+                g_cachedFactionIDs.emotionalTearsFaction = 0;
+                g_cachedFactionIDs.vampireTearsFaction = 0;
+                g_cachedFactionIDs.bloodyNoseFaction = 0;
+                g_detectedNPCNames.clear();
+                g_npcNameToRefID.clear();
+                g_activeSpellEffects.clear();
+                g_sceneTagStats.Reset(std::chrono::steady_clock::now());
+                g_currentAnimationInfo = AnimationTagInfo{};
+                g_sceneActors.clear();
+                g_scenePlayerPending = false;
+                g_lastOrgasmTimestamps.clear();
+                g_pendingSpellCasts.clear();
+                g_wenchPluginChecked = false;
+                g_wenchPluginExists = false;
+                g_ethelPluginChecked = false;
+                g_ethelPluginExists = false;
+                g_lastProcessedAnimationForTags = "";
+                g_vampireTearsPluginDetected = false;
+                ClearOrgasmCounters();
+                ClearBloodyNoseCounters();
+                g_actorClassCache.Clear();
+                CheckVampireTearsPluginAvailability();
+            });
             InitializePlugin();
             break;
 
@@ -6976,6 +10166,7 @@ void MessageListener(SKSE::MessagingInterface::Message* message) {
             g_cachedFactionIDs.vampireTearsFaction = 0;
             g_cachedFactionIDs.bloodyNoseFaction = 0;
             g_vampireTearsPluginDetected = false;
+            g_actorClassCache.Clear();
             CheckVampireTearsPluginAvailability();
             InitializeSpellCache();
             InitializeFactionCache();
@@ -6985,14 +10176,18 @@ void MessageListener(SKSE::MessagingInterface::Message* message) {
             {
                 auto& eventProcessor = GameEventProcessor::GetSingleton();
                 RE::UI::GetSingleton()->AddEventSink<RE::MenuOpenCloseEvent>(&eventProcessor);
+                RE::ScriptEventSourceHolder::GetSingleton()->AddEventSink<RE::TESSwitchRaceCompleteEvent>(&eventProcessor);
                 WriteToAnimationsLog("Game event processor registered", __LINE__);
                 WriteToActionsLog("Event monitoring system active", __LINE__);
                 
+                BuildPluginIndex();
                 ValidateAndUpdatePluginsInINI();
                 
+                ResolveActorClassForms();
                 InitializeSpellCache();
                 InitializeFactionCache();
                 CheckVampireTearsPluginAvailability();
+                StartSceneIndexBuild();
             }
             break;
 
@@ -7026,4 +10221,4 @@ constinit auto SKSEPlugin_Version = []() {
     v.CompatibleVersions({SKSE::RUNTIME_SSE_LATEST, SKSE::RUNTIME_LATEST_VR});
 
     return v;
-}();
\ No newline at end of file
+}();
@@ -0,0 +1,120 @@
+#include "ActorGrid.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                                       \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            g_failures++;                                                                      \
+        }                                                                                      \
+    } while (0)
+
+struct Point {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+};
+
+static std::vector<uint32_t> BruteForce(const std::vector<Point>& points, const Point& center, float radius) {
+    std::vector<uint32_t> result;
+    for (uint32_t i = 0; i < points.size(); i++) {
+        float dx = points[i].x - center.x;
+        float dy = points[i].y - center.y;
+        float dz = points[i].z - center.z;
+        if (dx * dx + dy * dy + dz * dz <= radius * radius) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+static std::vector<uint32_t> Query(const ActorGrid<Point>& grid, const std::vector<Point>& points, const Point& center,
+                                   float radius) {
+    std::vector<uint32_t> result;
+    grid.ForEachInRadius(points, center, radius, [&](uint32_t i) {
+        result.push_back(i);
+        return false;
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+static void TestMatchesBruteForce() {
+    std::mt19937 rng(0x4F524953);
+    std::uniform_real_distribution<float> coordinate(-16384.0f, 16384.0f);
+    std::uniform_real_distribution<float> height(-512.0f, 512.0f);
+
+    for (size_t count : {size_t(1), size_t(50), size_t(500), size_t(5000)}) {
+        std::vector<Point> points;
+        for (size_t i = 0; i < count; i++) {
+            points.push_back({coordinate(rng), coordinate(rng), height(rng)});
+        }
+        ActorGrid<Point> grid;
+        grid.Build(points);
+        CHECK(grid.entries.size() == count);
+        CHECK(grid.bucketStart.back() == count);
+
+        for (float radius : {100.0f, 500.0f, 1000.0f, 3000.0f}) {
+            for (int q = 0; q < 200; q++) {
+                Point center{coordinate(rng), coordinate(rng), 0.0f};
+                if (q % 4 == 0) {
+                    center = points[q % count];
+                }
+                CHECK(Query(grid, points, center, radius) == BruteForce(points, center, radius));
+            }
+        }
+    }
+}
+
+static void TestNegativeAndBoundaryCells() {
+    std::vector<Point> points = {{-1.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {511.9f, 0.0f, 0.0f}, {512.0f, 0.0f, 0.0f},
+                                 {-512.0f, -512.0f, 0.0f}};
+    for (int i = 0; i < 200; i++) {
+        points.push_back({100000.0f + i * 600.0f, 100000.0f, 0.0f});
+    }
+    ActorGrid<Point> grid;
+    grid.Build(points);
+
+    CHECK(ActorGrid<Point>::Cell(-1.0f) == -1);
+    CHECK(ActorGrid<Point>::Cell(511.9f) == 0);
+    CHECK(ActorGrid<Point>::Cell(512.0f) == 1);
+    CHECK(Query(grid, points, {0.0f, 0.0f, 0.0f}, 10.0f) == (std::vector<uint32_t>{0, 1}));
+    CHECK(Query(grid, points, {512.0f, 0.0f, 0.0f}, 1.0f) == (std::vector<uint32_t>{2, 3}));
+    CHECK(Query(grid, points, {-512.0f, -512.0f, 0.0f}, 0.0f) == (std::vector<uint32_t>{4}));
+}
+
+static void TestEarlyStopAndEmpty() {
+    std::vector<Point> points(100, Point{});
+    ActorGrid<Point> grid;
+    grid.Build(points);
+
+    int visited = 0;
+    bool stopped = grid.ForEachInRadius(points, Point{}, 10.0f, [&](uint32_t) { return ++visited == 3; });
+    CHECK(stopped);
+    CHECK(visited == 3);
+
+    std::vector<Point> none;
+    ActorGrid<Point> emptyGrid;
+    CHECK(!emptyGrid.ForEachInRadius(none, Point{}, 1000.0f, [](uint32_t) { return true; }));
+    emptyGrid.Build(none);
+    CHECK(!emptyGrid.ForEachInRadius(none, Point{}, 1000.0f, [](uint32_t) { return true; }));
+}
+
+int main() {
+    TestMatchesBruteForce();
+    TestNegativeAndBoundaryCells();
+    TestEarlyStopAndEmpty();
+
+    if (g_failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("ActorGrid: all checks passed\n");
+    return 0;
+}
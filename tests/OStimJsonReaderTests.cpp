@@ -0,0 +1,66 @@
+#include "OStimJsonReader.h"
+
+#include <cstdio>
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                                       \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            g_failures++;                                                                      \
+        }                                                                                      \
+    } while (0)
+
+static void TestFullPayload() {
+    OStimEventPayload payload;
+    CHECK(OStimJsonReader::Parse(
+        R"( {"SceneID":"BB_Standing_Kiss","Actors":[20,"0x0001A2B4",{"formID":"FF000800"},null],"Thread":"3",)"
+        R"("Speed":2.5,"Tags":["kissing","standing",7],"extra":{"nested":[1,{"a":"}"}]}} )",
+        payload));
+    CHECK(payload.sceneID == "BB_Standing_Kiss");
+    CHECK(payload.actorCount == 3);
+    CHECK(payload.actors[0] == 0x14);
+    CHECK(payload.actors[1] == 0x0001A2B4);
+    CHECK(payload.actors[2] == 0xFF000800);
+    CHECK(payload.threadID == 3);
+    CHECK(payload.speed == 2);
+    CHECK(payload.tagCount == 2);
+    CHECK(payload.tags[0] == "kissing");
+    CHECK(payload.tags[1] == "standing");
+}
+
+static void TestTagListStringAndNulls() {
+    OStimEventPayload payload;
+    CHECK(OStimJsonReader::Parse(R"({"tags":" oral , rough ,,","scene":null,"thread_id":0})", payload));
+    CHECK(payload.sceneID.empty());
+    CHECK(payload.threadID == 0);
+    CHECK(payload.tagCount == 2);
+    CHECK(payload.tags[0] == "oral");
+    CHECK(payload.tags[1] == "rough");
+
+    CHECK(OStimJsonReader::Parse("{}", payload));
+    CHECK(payload.threadID == -1);
+}
+
+static void TestRejectsMalformed() {
+    OStimEventPayload payload;
+    CHECK(!OStimJsonReader::LooksLikeJson("BB_Standing_Kiss"));
+    CHECK(!OStimJsonReader::Parse("BB_Standing_Kiss", payload));
+    CHECK(!OStimJsonReader::Parse(R"({"scene":"unterminated})", payload));
+    CHECK(!OStimJsonReader::Parse(R"({"scene" "missing colon"})", payload));
+    CHECK(!OStimJsonReader::Parse(R"({"thread":"x"})", payload));
+}
+
+int main() {
+    TestFullPayload();
+    TestTagListStringAndNulls();
+    TestRejectsMalformed();
+
+    if (g_failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("OStimJsonReader: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "OStimLogScanner.h"
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                                       \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            g_failures++;                                                                      \
+        }                                                                                      \
+    } while (0)
+
+static void TestNewlineFindersAgree() {
+    std::string text;
+    for (int i = 0; i < 200; i++) {
+        text.append(static_cast<size_t>(i % 41), 'x');
+        text.push_back('\n');
+    }
+
+    std::vector<FindNewlineFunc> finders = {FindNextNewlineScalar, FindNextNewlineSSE2};
+    if (IsAVX2Supported()) {
+        finders.push_back(FindNextNewlineAVX2);
+    }
+    const char* end = text.data() + text.size();
+    for (size_t offset = 0; offset < text.size(); offset++) {
+        const char* expected = FindNextNewlineScalar(text.data() + offset, end);
+        for (FindNewlineFunc finder : finders) {
+            CHECK(finder(text.data() + offset, end) == expected);
+        }
+        const char* previous = nullptr;
+        for (const char* p = text.data(); p < text.data() + offset; p++) {
+            if (*p == '\n') {
+                previous = p;
+            }
+        }
+        CHECK(FindPreviousNewline(text.data(), text.data() + offset) == previous);
+    }
+    CHECK(FindNextNewlineSSE2(text.data(), text.data()) == nullptr);
+}
+
+static void TestSplitLogLines() {
+    std::string_view chunk = "first\r\n\nsecond\nunterminated";
+    std::vector<std::string> lines;
+    size_t consumed = SplitLogLines(chunk.data(), chunk.size(), FindNextNewlineSSE2,
+                                    [&](std::string_view line) { lines.emplace_back(line); });
+    CHECK((lines == std::vector<std::string>{"first", "", "second"}));
+    CHECK(chunk.substr(consumed) == "unterminated");
+}
+
+static void TestLineChecks() {
+    CHECK(LineMayContainMarker("[12:00:00.000] [info] [Thread.cpp:195] thread 0 changed to node X"));
+    CHECK(LineMayContainMarker("[12:00:00.000] [info] voice set found for actor Lydia by default"));
+    CHECK(!LineMayContainMarker("[12:00:00.000] [info] [Furniture.cpp:231] checking furniture"));
+
+    CHECK(IsSceneEndMarker("[12:00:00.000] [info] [Thread.cpp:634] closing thread 0"));
+    CHECK(!IsSceneEndMarker("[12:00:00.000] [info] [Thread.cpp:195] thread 0 changed to node X"));
+
+    CHECK(ParseThreadIDFromLine("[info] thread 12 changed to node X") == 12);
+    CHECK(ParseThreadIDFromLine("[info] thread 0 changed") == 0);
+    CHECK(ParseThreadIDFromLine("[info] closing thread") == -1);
+
+    long long ms = 0;
+    CHECK(ParseLogLineTimeOfDayMs("[01:02:03.004] [info]", ms) && ms == 3723004);
+    CHECK(ParseLogLineTimeOfDayMs("[2024-05-06 01:02:03.004] [info]", ms) && ms == 3723004);
+    CHECK(ParseLogLineTimeOfDayMs("[01:02:03] [info]", ms) && ms == 3723000);
+    CHECK(!ParseLogLineTimeOfDayMs("no timestamp", ms));
+}
+
+static void TestExtraction() {
+    CHECK(DetectAnimationChange("[t] [info] [Thread.cpp:195] thread 0 changed to node BB_Standing_Kiss \r") ==
+          "BB_Standing_Kiss");
+    CHECK(DetectAnimationChange("[t] [info] [OStimMenu.h:48] UI_TransitionRequest {BB_Missionary}") == "BB_Missionary");
+    CHECK(DetectAnimationChange("[t] [debug] [Thread.cpp:195] thread 0 changed to node X").empty());
+
+    CHECK(ExtractVoiceSetActorName("[t] [info] voice set Female found for actor Lydia by race") == "Lydia");
+    CHECK(ExtractVoiceSetActorName("[t] [info] no voice set found for actor  Aela the Huntress , using default") ==
+          "Aela the Huntress");
+    CHECK(ExtractVoiceSetActorName("[t] [info] no voice set found for actor , using default").empty());
+    CHECK(ExtractVoiceSetActorName("[t] [info] found for actor Lydia by race").empty());
+}
+
+int main() {
+    TestNewlineFindersAgree();
+    TestSplitLogLines();
+    TestLineChecks();
+    TestExtraction();
+
+    if (g_failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("OStimLogScanner: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "SceneStateMachine.h"
+
+#include <cstdio>
+#include <initializer_list>
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                                       \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            g_failures++;                                                                      \
+        }                                                                                      \
+    } while (0)
+
+static bool Is(SceneTransition transition, SceneState next, uint32_t actions) {
+    return transition.next == next && transition.actions == actions;
+}
+
+static void TestNormalLifecycle() {
+    CHECK(Is(EvaluateSceneTransition(SceneState::Idle, SceneInputKind::Prestart), SceneState::Prestart,
+             kSceneActionBuildCache));
+    CHECK(Is(EvaluateSceneTransition(SceneState::Prestart, SceneInputKind::SceneStart), SceneState::Active,
+             kSceneActionStartScene));
+    CHECK(Is(EvaluateSceneTransition(SceneState::Active, SceneInputKind::End), SceneState::Ending,
+             kSceneActionEndScene));
+    CHECK(Is(EvaluateSceneTransition(SceneState::Ending, SceneInputKind::CleanupDue), SceneState::CleanupPending,
+             kSceneActionRunCleanup));
+    CHECK(Is(EvaluateSceneTransition(SceneState::CleanupPending, SceneInputKind::CleanupDone), SceneState::Idle,
+             kSceneActionNone));
+}
+
+static void TestStartWithoutPrestart() {
+    CHECK(Is(EvaluateSceneTransition(SceneState::Idle, SceneInputKind::SceneStart), SceneState::Active,
+             kSceneActionBuildCache | kSceneActionStartScene));
+    CHECK(Is(EvaluateSceneTransition(SceneState::Prestart, SceneInputKind::End), SceneState::Idle,
+             kSceneActionClearCache));
+}
+
+static void TestNewSceneWhileEndingWaitsForCleanup() {
+    for (SceneInputKind input : {SceneInputKind::Prestart, SceneInputKind::SceneStart}) {
+        SceneTransition transition = EvaluateSceneTransition(SceneState::Ending, input);
+        CHECK(Is(transition, SceneState::Ending, kSceneActionDeferInput));
+        CHECK((transition.actions & kSceneActionRunCleanup) == 0);
+    }
+}
+
+static void TestCleanupPendingIsAState() {
+    SceneTransition cleanup = EvaluateSceneTransition(SceneState::Ending, SceneInputKind::CleanupDue);
+    CHECK(cleanup.next == SceneState::CleanupPending);
+    CHECK(Is(EvaluateSceneTransition(cleanup.next, SceneInputKind::End), SceneState::CleanupPending,
+             kSceneActionNone));
+    CHECK(Is(EvaluateSceneTransition(cleanup.next, SceneInputKind::SceneStart), SceneState::Active,
+             kSceneActionBuildCache | kSceneActionStartScene));
+    CHECK(Is(EvaluateSceneTransition(cleanup.next, SceneInputKind::Prestart), SceneState::Prestart,
+             kSceneActionBuildCache));
+}
+
+static void TestIgnoredInputsKeepState() {
+    CHECK(Is(EvaluateSceneTransition(SceneState::Idle, SceneInputKind::End), SceneState::Idle, kSceneActionNone));
+    CHECK(Is(EvaluateSceneTransition(SceneState::Active, SceneInputKind::SceneStart), SceneState::Active,
+             kSceneActionNone));
+    CHECK(Is(EvaluateSceneTransition(SceneState::Active, SceneInputKind::CleanupDone), SceneState::Active,
+             kSceneActionNone));
+    CHECK(Is(EvaluateSceneTransition(SceneState::Ending, SceneInputKind::End), SceneState::Ending,
+             kSceneActionNone));
+}
+
+int main() {
+    TestNormalLifecycle();
+    TestStartWithoutPrestart();
+    TestNewSceneWhileEndingWaitsForCleanup();
+    TestCleanupPendingIsAState();
+    TestIgnoredInputsKeepState();
+
+    if (g_failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("SceneStateMachine: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "SceneTags.h"
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static int g_failures = 0;
+
+#define CHECK(condition)                                                                       \
+    do {                                                                                       \
+        if (!(condition)) {                                                                    \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            g_failures++;                                                                      \
+        }                                                                                      \
+    } while (0)
+
+static void TestKeywordAutomaton() {
+    TagSet tags = TagSet::FromBits(kTagKeywordAutomaton.Match("OStim_Standing_BJ"));
+    CHECK(tags.HasAny(kSceneTagStanding));
+    CHECK(tags.HasAny(kSceneTagOral));
+    CHECK(std::string(GetScenePositionName(tags)) == "Standing");
+    CHECK(std::string(GetSceneIntensityName(tags)) == "Normal");
+    CHECK(FormatTagSet(tags, ",") == "Standing,Oral");
+
+    CHECK(kTagKeywordAutomaton.Match("") == 0);
+    CHECK(std::string(GetScenePositionName(TagSet{})) == "Unknown");
+}
+
+static void TestRuleAutomaton() {
+    std::istringstream rules(
+        "; comment\n"
+        "[Other]\n"
+        "ignored = Ignored\n"
+        "[Rules]\n"
+        "feet = FootPlay, word\n"
+        "rough = Rough, !roughhouse\n"
+        "bad line\n"
+        "kiss = Kissing, sideways\n");
+    std::vector<std::string> messages;
+    auto automaton = CompileTagRules(
+        rules, [](std::string_view tag) { return TagNameTable::Get().InternConfigured(tag); },
+        [&](const std::string& message) { messages.push_back(message); });
+    CHECK(automaton != nullptr);
+    if (!automaton) {
+        return;
+    }
+    CHECK(automaton->ruleCount == 2);
+
+    uint32_t footPlay = TagNameTable::Get().InternConfigured("FootPlay");
+    uint32_t rough = TagNameTable::Get().InternConfigured("Rough");
+    CHECK(automaton->Match("BB_Feet_Play").Has(footPlay));
+    CHECK(!automaton->Match("BB_Feetsy").Has(footPlay));
+    CHECK(automaton->Match("Rough_Doggy").Has(rough));
+    CHECK(!automaton->Match("Roughhouse_Doggy").Has(rough));
+    CHECK(std::string(GetSceneIntensityName(automaton->Match("Rough_Doggy"))) == "High");
+    CHECK(!messages.empty());
+
+    std::istringstream empty("[Rules]\n");
+    CHECK(CompileTagRules(empty, [](std::string_view) { return kInvalidTagID; }, [](const std::string&) {}) == nullptr);
+}
+
+int main() {
+    TestKeywordAutomaton();
+    TestRuleAutomaton();
+
+    if (g_failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("SceneTags: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,372 @@
+#include "OStimLogScanner.h"
+#include "SceneStateMachine.h"
+#include "SceneTags.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Replays an OStim.log through the plugin's engine-free ingest path - line splitter, marker
+// pre-filter, animation and actor-name extraction, tag matching and the scene state machine - and
+// prints the same [Replay] stats and [Decisions] lines as the in-game replay. Decisions that need
+// the game (scene index metadata, cached actor lookups, spells) are not reproduced: every actor
+// reads as not_cached and no SPELL lines are emitted.
+//
+// Usage: OStimLogReplay <OStim.log> [--realtime] [--rules <tag rules file>] [--out <report>]
+
+static thread_local bool t_countAllocations = false;
+static std::atomic<size_t> g_allocationCount(0);
+
+// Counts allocations made while a line is processed. The default array and nothrow forms forward
+// here; over-aligned allocations are not counted.
+void* operator new(std::size_t size) {
+    if (t_countAllocations) {
+        g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        void* ptr = std::malloc(size);
+        if (ptr) {
+            return ptr;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+struct ReplayOptions {
+    std::string logPath;
+    std::string rulesPath;
+    std::string outPath;
+    bool realtime = false;
+};
+
+// Mirrors ProcessNewLine and ApplySceneInput in plugin.cpp, minus everything that touches the game.
+struct ReplaySession {
+    struct DeferredInput {
+        SceneInputKind kind;
+        std::string animationName;
+    };
+
+    std::shared_ptr<const TagRuleAutomaton> rules;
+    SceneState state = SceneState::Idle;
+    std::optional<DeferredInput> deferredInput;
+    bool cleanupDonePending = false;
+    long long sceneEndLogMs = -1;
+    std::string lastAnimation;
+    std::unordered_set<size_t> processedLines;
+    std::unordered_set<std::string> detectedNames;
+    size_t currentLine = 0;
+    std::vector<std::string> decisions;
+
+    void Record(std::string_view kind, std::string_view detail) {
+        std::string decision = std::to_string(currentLine);
+        decision += '|';
+        decision += kind;
+        decision += '|';
+        decision += detail;
+        decisions.push_back(std::move(decision));
+    }
+
+    void RecordTags(const std::string& animationName) {
+        TagSet tags = rules ? rules->Match(animationName) : TagSet::FromBits(kTagKeywordAutomaton.Match(animationName));
+        Record("TAGS", animationName + "|" + GetScenePositionName(tags) + "|" + GetSceneIntensityName(tags) + "|" +
+                           FormatTagSet(tags, ","));
+    }
+
+    SceneState Apply(SceneInputKind kind, const std::string& animationName) {
+        SceneState previousState = state;
+        SceneTransition transition = EvaluateSceneTransition(previousState, kind);
+
+        if (transition.actions & kSceneActionDeferInput) {
+            deferredInput = DeferredInput{kind, animationName};
+            return previousState;
+        }
+        if (kind == SceneInputKind::Prestart || kind == SceneInputKind::SceneStart) {
+            deferredInput.reset();
+        }
+
+        if (transition.actions & kSceneActionRunCleanup) {
+            Record("CLEANUP", "scene end");
+        }
+        if (transition.actions & kSceneActionStartScene) {
+            Record("SCENE_START", animationName);
+        }
+        if (transition.actions & kSceneActionEndScene) {
+            Record("SCENE_END", lastAnimation);
+            detectedNames.clear();
+        }
+
+        state = transition.next;
+
+        // The plugin posts CleanupDone to the scene strand, where it runs before the next line task
+        // and so still under the previous line's number.
+        if (state == SceneState::CleanupPending) {
+            cleanupDonePending = true;
+        } else if (state == SceneState::Idle && deferredInput) {
+            DeferredInput deferred = std::move(*deferredInput);
+            deferredInput.reset();
+            Apply(deferred.kind, deferred.animationName);
+        }
+        return previousState;
+    }
+
+    void RunPendingCleanupDone() {
+        if (cleanupDonePending) {
+            cleanupDonePending = false;
+            Apply(SceneInputKind::CleanupDone, {});
+        }
+    }
+
+    // Same rule as AdvanceReplayCleanupClock in plugin.cpp.
+    void AdvanceCleanupClock(long long logTimeMs, bool endOfFile) {
+        if (state != SceneState::Ending) {
+            sceneEndLogMs = -1;
+            return;
+        }
+        bool delayElapsed = sceneEndLogMs >= 0 && logTimeMs >= 0 &&
+                            (logTimeMs - sceneEndLogMs >= kSceneCleanupDelayMs || logTimeMs < sceneEndLogMs);
+        if (delayElapsed || endOfFile) {
+            sceneEndLogMs = -1;
+            Apply(SceneInputKind::CleanupDue, {});
+        }
+    }
+
+    void DetectActorName(std::string_view line) {
+        std::string_view name = ExtractVoiceSetActorName(line);
+        if (name.empty()) {
+            return;
+        }
+        std::string key(name);
+        std::transform(key.begin(), key.end(), key.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (detectedNames.insert(std::move(key)).second) {
+            Record("ACTOR", std::string(name) + "|not_cached");
+        }
+    }
+
+    // Returns whether the line passed the marker pre-filter.
+    bool ProcessLine(std::string_view line, long long logTimeMs) {
+        AdvanceCleanupClock(logTimeMs, false);
+
+        if (!LineMayContainMarker(line)) {
+            return false;
+        }
+        if (line.find("[warning]") != std::string_view::npos) {
+            return true;
+        }
+
+        size_t lineHash = std::hash<std::string_view>{}(line);
+        if (processedLines.contains(lineHash)) {
+            return true;
+        }
+        // NPC thread lines resolve actors through the game.
+        if (ParseThreadIDFromLine(line) > 0) {
+            return true;
+        }
+
+        std::string_view animationName = DetectAnimationChange(line);
+        DetectActorName(line);
+
+        if (IsSceneEndMarker(line)) {
+            processedLines.insert(lineHash);
+            Apply(SceneInputKind::End, {});
+        } else if (!animationName.empty()) {
+            processedLines.insert(lineHash);
+            if (animationName != lastAnimation) {
+                lastAnimation.assign(animationName);
+                Record("ANIMATION", lastAnimation);
+                RecordTags(lastAnimation);
+                Apply(SceneInputKind::SceneStart, lastAnimation);
+                if (processedLines.size() > 500) {
+                    processedLines.clear();
+                }
+            }
+        }
+
+        if (state == SceneState::Ending && sceneEndLogMs < 0) {
+            sceneEndLogMs = logTimeMs;
+        }
+        return true;
+    }
+
+    void Finish(long long logTimeMs) {
+        RunPendingCleanupDone();
+        AdvanceCleanupClock(logTimeMs, true);
+        RunPendingCleanupDone();
+    }
+};
+
+static bool ParseOptions(int argc, char** argv, ReplayOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--realtime") {
+            options.realtime = true;
+        } else if (arg == "--rules" && i + 1 < argc) {
+            options.rulesPath = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outPath = argv[++i];
+        } else if (!arg.starts_with("--") && options.logPath.empty()) {
+            options.logPath = arg;
+        } else {
+            return false;
+        }
+    }
+    return !options.logPath.empty();
+}
+
+int main(int argc, char** argv) {
+    ReplayOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage: %s <OStim.log> [--realtime] [--rules <tag rules file>] [--out <report>]\n",
+                     argc > 0 ? argv[0] : "OStimLogReplay");
+        return 2;
+    }
+
+    std::ifstream logFile(options.logPath, std::ios::in | std::ios::binary);
+    if (!logFile.is_open()) {
+        std::fprintf(stderr, "Cannot open replay file: %s\n", options.logPath.c_str());
+        return 1;
+    }
+    std::string content((std::istreambuf_iterator<char>(logFile)), std::istreambuf_iterator<char>());
+    logFile.close();
+
+    ReplaySession session;
+    session.decisions.reserve(4096);
+    if (!options.rulesPath.empty()) {
+        std::ifstream rulesFile(options.rulesPath);
+        if (!rulesFile.is_open()) {
+            std::fprintf(stderr, "Cannot open tag rules file: %s\n", options.rulesPath.c_str());
+            return 1;
+        }
+        session.rules = CompileTagRules(
+            rulesFile, [](std::string_view tag) { return TagNameTable::Get().InternConfigured(tag); },
+            [](const std::string& message) { std::fprintf(stderr, "%s\n", message.c_str()); });
+    }
+
+    FindNewlineFunc findNewline = IsAVX2Supported() ? FindNextNewlineAVX2 : FindNextNewlineSSE2;
+
+    std::vector<uint32_t> lineLatenciesNs;
+    lineLatenciesNs.reserve(content.size() / 64 + 1);
+
+    size_t linesSeen = 0;
+    size_t linesProcessed = 0;
+    bool havePreviousTimestamp = false;
+    long long previousTimestampMs = 0;
+    long long logTimeMs = -1;
+
+    auto processLine = [&](std::string_view line) {
+        linesSeen++;
+
+        long long timestampMs = 0;
+        if (ParseLogLineTimeOfDayMs(line, timestampMs)) {
+            logTimeMs = timestampMs;
+            if (options.realtime) {
+                if (havePreviousTimestamp && timestampMs > previousTimestampMs) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(timestampMs - previousTimestampMs));
+                }
+                previousTimestampMs = timestampMs;
+                havePreviousTimestamp = true;
+            }
+        }
+
+        session.RunPendingCleanupDone();
+        session.currentLine = linesSeen;
+        auto lineStartTime = std::chrono::steady_clock::now();
+        t_countAllocations = true;
+        if (session.ProcessLine(line, logTimeMs)) {
+            linesProcessed++;
+        }
+        t_countAllocations = false;
+        long long lineNs =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - lineStartTime).count();
+        lineLatenciesNs.push_back(static_cast<uint32_t>(std::min<long long>(lineNs, UINT32_MAX)));
+    };
+
+    auto replayStartTime = std::chrono::steady_clock::now();
+    size_t consumed = SplitLogLines(content.data(), content.size(), findNewline, processLine);
+    if (consumed < content.size()) {
+        std::string_view tail(content.data() + consumed, content.size() - consumed);
+        if (tail.ends_with('\r')) {
+            tail.remove_suffix(1);
+        }
+        processLine(tail);
+    }
+    session.Finish(logTimeMs);
+    auto elapsedUs =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - replayStartTime).count();
+    size_t allocations = g_allocationCount.load();
+
+    uint32_t p50 = 0;
+    uint32_t p99 = 0;
+    uint32_t maxLatency = 0;
+    if (!lineLatenciesNs.empty()) {
+        std::vector<uint32_t> sorted = lineLatenciesNs;
+        std::sort(sorted.begin(), sorted.end());
+        p50 = sorted[sorted.size() / 2];
+        p99 = sorted[std::min(sorted.size() - 1, (sorted.size() * 99) / 100)];
+        maxLatency = sorted.back();
+    }
+
+    double seconds = elapsedUs / 1000000.0;
+    double linesPerSecond = seconds > 0.0 ? linesSeen / seconds : 0.0;
+    double allocationsPerLine = linesSeen > 0 ? static_cast<double>(allocations) / linesSeen : 0.0;
+
+    std::ofstream reportFile;
+    if (!options.outPath.empty()) {
+        reportFile.open(options.outPath, std::ios::trunc);
+        if (!reportFile.is_open()) {
+            std::fprintf(stderr, "Cannot write report: %s\n", options.outPath.c_str());
+            return 1;
+        }
+    }
+    std::ostream& report = reportFile.is_open() ? reportFile : std::cout;
+
+    report << "[Replay]" << std::endl;
+    report << "File=" << options.logPath << std::endl;
+    report << "Realtime=" << (options.realtime ? "true" : "false") << std::endl;
+    report << "Bytes=" << content.size() << std::endl;
+    report << "Lines=" << linesSeen << std::endl;
+    report << "LinesPassedFilter=" << linesProcessed << std::endl;
+    report << "ElapsedMs=" << (elapsedUs / 1000) << std::endl;
+    report << "LinesPerSecond=" << static_cast<long long>(linesPerSecond) << std::endl;
+    report << "AllocationsPerLine=" << std::fixed << std::setprecision(3) << allocationsPerLine << std::endl;
+    report << "LatencyP50Ns=" << p50 << std::endl;
+    report << "LatencyP99Ns=" << p99 << std::endl;
+    report << "LatencyMaxNs=" << maxLatency << std::endl;
+    report << "Splitter=" << (findNewline == FindNextNewlineAVX2 ? "AVX2" : "SSE2") << std::endl;
+    report << std::endl;
+    report << "[Decisions]" << std::endl;
+    for (const auto& decision : session.decisions) {
+        report << decision << std::endl;
+    }
+    return 0;
+}